@@ -0,0 +1,47 @@
+#include "mngr/assetLoader.hpp"
+#include "mngr/threadPool.hpp"
+#include <cstdio>
+#include <cstring>
+
+// Decodes every sprite and sound the loading screen does, once on one thread and once on the thread pool, without
+// ever opening a window or an audio device. nothing is uploaded. run it from the repository root
+//
+// usage: sandbox_asset_bench [--times]
+
+// Helper functions
+
+static float decodeAll(bool parallel, bool printTimes) {
+   AssetLoader loader;
+   loader.parallel = parallel;
+   loader.addFolder("assets/sprites/", DecodedAsset::Kind::texture);
+   loader.addFolder("assets/sounds/", DecodedAsset::Kind::sound);
+   loader.decode();
+
+   int failed = 0;
+   for (const DecodedAsset &asset: loader.assets) {
+      failed += (asset.kind == DecodedAsset::Kind::texture ? !asset.image.data : !asset.wave.data);
+   }
+
+   if (printTimes) {
+      loader.printDecodeTimes();
+   }
+   if (failed != 0) {
+      printf("sandbox_asset_bench: %d assets failed to decode.\n", failed);
+   }
+   return loader.decodeMs;
+}
+
+int main(int argc, char **argv) {
+   bool printTimes = (argc > 1 && std::strcmp(argv[1], "--times") == 0);
+
+   float serialMs = decodeAll(false, false);
+   float parallelMs = decodeAll(true, printTimes);
+
+   char threads[32];
+   snprintf(threads, sizeof(threads), "%d threads", getThreadPool().getThreadCount());
+
+   printf("\nDecoding all assets\n");
+   printf("  %-15s %10.2fms\n", "1 thread", serialMs);
+   printf("  %-15s %10.2fms (%.2fx)\n", threads, parallelMs, (parallelMs > 0.0f ? serialMs / parallelMs : 0.0f));
+   return 0;
+}
@@ -0,0 +1,148 @@
+#include "mngr/data.hpp"
+#include "mngr/fileio.hpp"
+#include "objs/console.hpp"
+#include "objs/generation.hpp"
+#include "objs/inventory.hpp"
+#include "objs/physics.hpp"
+#include "objs/player.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Generates or loads a world and runs the cell physics over all of it for a number of fixed ticks, without ever
+// opening a window. run it from the repository root, it reads assets/config and writes to data/worlds like the game.
+//
+// usage: sandbox_bench [--generate sizeX sizeY] [--flat] [--load name] [--seed n] [--ticks n] [--serial] [--progressive]
+
+// Constants
+
+constexpr int defaultSizeX = 2000;
+constexpr int defaultSizeY = 750;
+constexpr int defaultTicks = 1000;
+constexpr uint64_t defaultSeed = 1;
+constexpr const char *benchWorldName = "bench";
+
+// Helper functions
+
+static double getMilliseconds(std::chrono::steady_clock::time_point begin) {
+   return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+static void printUsage() {
+   printf("usage: sandbox_bench [--generate sizeX sizeY] [--flat] [--load name] [--seed n] [--ticks n] [--serial] [--progressive]\n");
+}
+
+int main(int argc, char **argv) {
+   std::string worldName = benchWorldName;
+   int sizeX = defaultSizeX, sizeY = defaultSizeY, ticks = defaultTicks;
+   uint64_t seed = defaultSeed;
+   bool generate = true, flat = false, serial = false, progressive = false;
+
+   for (int i = 1; i < argc; ++i) {
+      if (std::strcmp(argv[i], "--generate") == 0 && i + 2 < argc) {
+         sizeX = std::atoi(argv[++i]);
+         sizeY = std::atoi(argv[++i]);
+      } else if (std::strcmp(argv[i], "--load") == 0 && i + 1 < argc) {
+         worldName = argv[++i];
+         generate = false;
+      } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+         seed = getSeedFromString(argv[++i]);
+      } else if (std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+         ticks = std::atoi(argv[++i]);
+      } else if (std::strcmp(argv[i], "--flat") == 0) {
+         flat = true;
+      } else if (std::strcmp(argv[i], "--serial") == 0) {
+         serial = true;
+      } else if (std::strcmp(argv[i], "--progressive") == 0) {
+         progressive = true;
+      } else {
+         printUsage();
+         return 1;
+      }
+   }
+
+   if (sizeX <= 0 || sizeY <= 0 || ticks < 0) {
+      printUsage();
+      return 1;
+   }
+   loadData(true);
+
+   // Generate. the generator saves the world itself, same as from the menu
+   double generateMs = 0.0;
+   std::vector<std::pair<std::string, double>> passTimes;
+   if (generate) {
+      std::mutex infoTextMutex;
+      std::string infoText;
+      float progress = 0.0f;
+
+      auto begin = std::chrono::steady_clock::now();
+      MapGenerator generator (worldName, sizeX, sizeY, flat, seed, infoTextMutex, infoText, progress);
+      generator.generate();
+      generateMs = getMilliseconds(begin);
+      passTimes = generator.passTimes;
+   }
+
+   // Load
+   Map map;
+   Player player;
+   Console console;
+   Inventory inventory;
+   std::vector<DroppedItem> droppedItems;
+   float zoom = 0.0f;
+
+   // a progressive load returns with the bands around the player in, which is when the game shows its first frame.
+   // the rest is waited for so the simulation always gets the whole world
+   WorldLoad worldLoad;
+   auto loadBegin = std::chrono::steady_clock::now();
+   bool loaded = loadWorldData(worldName, player, zoom, map, console, inventory, droppedItems, (progressive ? &worldLoad : nullptr));
+   double firstFrameMs = getMilliseconds(loadBegin);
+   worldLoad.finish(map);
+   double loadMs = getMilliseconds(loadBegin);
+
+   if (!loaded) {
+      printf("sandbox_bench: Failed to load world '%s'.\n", worldName.c_str());
+      return 1;
+   }
+
+   // Simulate. the whole map counts as near, so every awake cell gets updated every tick
+   Physics physics (map);
+   physics.init();
+   physics.parallelPhysics = !serial;
+   physics.farPhysics = false;
+
+   Rectangle everything = {0, 0, float(map.sizeX - 1), float(map.sizeY - 1)};
+   long long cellsUpdated = 0;
+   auto tickBegin = std::chrono::steady_clock::now();
+
+   for (int i = 0; i < ticks; ++i) {
+      physics.updateNearPhysics(everything);
+      cellsUpdated += physics.cellsUpdated;
+   }
+   double tickMs = getMilliseconds(tickBegin);
+
+   // Save next to the original so benchmarking never touches a real world
+   std::string saveName = worldName + "_bench";
+   auto saveBegin = std::chrono::steady_clock::now();
+   saveWorldData(saveName, player.spawnPos, player.position, player.creative, player.breath, player.hearts, player.maxHearts, zoom, 0.0f, 0, map, &console, nullptr, &droppedItems);
+   double saveMs = getMilliseconds(saveBegin);
+   deleteWorld(saveName);
+
+   // Report
+   double ticksPerSecond = (tickMs > 0.0 ? ticks / (tickMs / 1000.0) : 0.0);
+   printf("\nWorld '%s' (%dx%d, seed %llu), %d ticks on %s\n", worldName.c_str(), map.sizeX, map.sizeY, (unsigned long long)map.seed, ticks, (serial ? "1 thread" : "the thread pool"));
+   if (generate) {
+      printf("  generate        %10.2fms\n", generateMs);
+      for (const auto &[text, ms]: passTimes) {
+         printf("    %-28s %10.2fms\n", text.c_str(), ms);
+      }
+   }
+   printf("  load            %10.2fms\n", loadMs);
+   if (progressive) {
+      printf("    first frame     %10.2fms\n", firstFrameMs);
+   }
+   printf("  save            %10.2fms\n", saveMs);
+   printf("  simulate        %10.2fms (%.1f ticks/s)\n", tickMs, ticksPerSecond);
+   printf("  cells updated   %10lld (%.1f per tick)\n", cellsUpdated, (ticks > 0 ? double(cellsUpdated) / ticks : 0.0));
+   return 0;
+}
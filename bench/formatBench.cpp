@@ -0,0 +1,430 @@
+#include "mngr/data.hpp"
+#include "mngr/fileio.hpp"
+#include "objs/console.hpp"
+#include "objs/generation.hpp"
+#include "objs/inventory.hpp"
+#include "objs/player.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <mutex>
+
+// Generates worlds of a few sizes and seeds, then saves and loads each one with the current file format, checks that
+// every tile comes back the same (the check counts towards the load time) and compares the size of the whole file
+// against just the count and ID pairs version 16 wrote for the map. every world is also written in the layouts of
+// versions 13 to 18 and has to come back the same after being upgraded, and saved again with a row changed at a time
+// until it gets compacted, coming back the same after every save. run it from the repository root, it reads
+// assets/config and writes to data/worlds like the game. exits with 1 if any world didn't come back the same
+//
+// usage: sandbox_format_bench [--check]
+// --check only runs the smallest world once, which is what ctest runs
+
+// Constants
+
+constexpr int benchIterations = 3;
+constexpr int worldSizes[][2] = {{1000, 400}, {2000, 750}, {4000, 1200}};
+constexpr uint64_t seeds[] = {1, 42};
+constexpr int legacyVersions[] = {13, 15, 16, 17, 18};
+constexpr int incrementalSaves = 24;
+constexpr const char *benchWorldName = "format_bench";
+constexpr int legacyBandRows = 32;
+constexpr size_t headerSize = 7 * sizeof(int) + 6 * sizeof(float) + sizeof(bool) + sizeof(uint64_t);
+
+// Helper functions
+
+template<class Function>
+static double measure(int iterations, Function function) {
+   auto begin = std::chrono::steady_clock::now();
+   for (int i = 0; i < iterations; ++i) {
+      function();
+   }
+   auto end = std::chrono::steady_clock::now();
+   return std::chrono::duration<double, std::milli>(end - begin).count() / iterations;
+}
+
+// the (count, value) pairs version 16 and older wrote for tiles begin to end - 1, with counts capped at what T holds
+template<class T, class Function>
+static std::vector<T> getLegacyRuns(int begin, int end, Function getId) {
+   std::vector<T> runs;
+   long long maxCount = std::numeric_limits<T>::max();
+   long long count = 0;
+   T last = 0;
+
+   for (int i = begin; i < end; ++i) {
+      T id = getId(i);
+      if (count != 0 && (id != last || count == maxCount)) {
+         runs.push_back(count);
+         runs.push_back(last);
+         count = 0;
+      }
+      last = id;
+      count += 1;
+   }
+
+   if (count != 0) {
+      runs.push_back(count);
+      runs.push_back(last);
+   }
+   return runs;
+}
+
+// the map section of version 16, an index of band offsets then four run lists with their sizes in every band
+static size_t getLegacyMapSize(const Map &map) {
+   int bandCount = (map.sizeY + legacyBandRows - 1) / legacyBandRows;
+   size_t size = 2 * sizeof(int) + (bandCount + 1) * sizeof(size_t);
+
+   for (int band = 0; band < bandCount; ++band) {
+      int begin = band * legacyBandRows * map.sizeX;
+      int end = std::min(map.sizeY, (band + 1) * legacyBandRows) * map.sizeX;
+
+      size += 4 * sizeof(size_t);
+      size += sizeof(blockid_t) * getLegacyRuns<blockid_t>(begin, end, [&](int i) { return (map.blocks[i].tile == TileType::root) * map.blocks[i].id; }).size();
+      size += sizeof(blockid_t) * getLegacyRuns<blockid_t>(begin, end, [&](int i) { return map.walls[i].id; }).size();
+      size += sizeof(int) * getLegacyRuns<int>(begin, end, [&](int i) { return map.liquidTypes[i]; }).size();
+      size += sizeof(int) * getLegacyRuns<int>(begin, end, [&](int i) { return map.liquidHeights[i]; }).size();
+   }
+   return size;
+}
+
+static bool isSameMap(const Map &a, const Map &b, bool checkSeed) {
+   if (a.sizeX != b.sizeX || a.sizeY != b.sizeY || (checkSeed && a.seed != b.seed)) {
+      return false;
+   }
+
+   for (size_t i = 0; i < a.blocks.size(); ++i) {
+      // ghost tiles are saved as air and come back from the furniture
+      blockid_t blockA = (a.blocks[i].tile == TileType::root) * a.blocks[i].id;
+      blockid_t blockB = (b.blocks[i].tile == TileType::root) * b.blocks[i].id;
+
+      if (blockA != blockB || a.walls[i].id != b.walls[i].id || a.liquidTypes[i] != b.liquidTypes[i] || a.liquidHeights[i] != b.liquidHeights[i]) {
+         return false;
+      }
+   }
+   return true;
+}
+
+static bool loadAndCompare(const Map &map, bool checkSeed) {
+   Map loaded;
+   Player player;
+   Console console;
+   Inventory inventory;
+   std::vector<DroppedItem> droppedItems;
+   float zoom = 0.0f;
+   return loadWorldData(benchWorldName, player, zoom, loaded, console, inventory, droppedItems) && isSameMap(map, loaded, checkSeed);
+}
+
+// Legacy writers, the layouts upgradeWorld reads. every world gets an empty inventory, history and no furniture
+
+template<class T>
+static void writeValue(std::ofstream &file, const T &value) {
+   file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<class T>
+static void writeRuns(std::ofstream &file, const std::vector<T> &runs) {
+   file.write(reinterpret_cast<const char*>(runs.data()), runs.size() * sizeof(T));
+}
+
+// versions 13 to 16. before version 17 counts were size_t
+static void writeLegacyWorld(const std::string &filename, int version, const Map &map) {
+   std::ofstream file (filename, std::ios::binary);
+   writeValue(file, version);
+   writeValue(file, 10.0f);
+   writeValue(file, 10.0f);
+   writeValue(file, 10.0f);
+   writeValue(file, 10.0f);
+   writeValue(file, false);
+   writeValue(file, 100);
+   writeValue(file, 100);
+   writeValue(file, 100);
+   writeValue(file, map.sizeX);
+   writeValue(file, map.sizeY);
+   writeValue(file, 50.0f);
+   writeValue(file, 0.0f);
+   writeValue(file, 0);
+   if (version >= 14) {
+      writeValue(file, map.seed);
+   }
+
+   std::vector<Item> items (realInventorySlots);
+   file.write(reinterpret_cast<const char*>(items.data()), items.size() * sizeof(Item));
+   writeValue<size_t>(file, 0); // console history
+
+   auto getBlock = [&](int i) { return (map.blocks[i].tile == TileType::root) * map.blocks[i].id; };
+   auto getWall = [&](int i) { return map.walls[i].id; };
+   auto getLiquidType = [&](int i) { return (int)map.liquidTypes[i]; };
+   auto getLiquidHeight = [&](int i) { return (int)map.liquidHeights[i]; };
+
+   if (version >= 16) {
+      int bandCount = (map.sizeY + legacyBandRows - 1) / legacyBandRows;
+      std::vector<std::vector<char>> bands (bandCount);
+
+      for (int band = 0; band < bandCount; ++band) {
+         int begin = band * legacyBandRows * map.sizeX;
+         int end = std::min(map.sizeY, (band + 1) * legacyBandRows) * map.sizeX;
+         std::vector<blockid_t> blocks = getLegacyRuns<blockid_t>(begin, end, getBlock);
+         std::vector<blockid_t> walls = getLegacyRuns<blockid_t>(begin, end, getWall);
+         std::vector<int> types = getLegacyRuns<int>(begin, end, getLiquidType);
+         std::vector<int> heights = getLegacyRuns<int>(begin, end, getLiquidHeight);
+
+         size_t counts[] = {blocks.size(), walls.size(), types.size(), heights.size()};
+         auto append = [&](const void *data, size_t bytes) {
+            bands[band].insert(bands[band].end(), (const char*)data, (const char*)data + bytes);
+         };
+         append(counts, sizeof(counts));
+         append(blocks.data(), blocks.size() * sizeof(blockid_t));
+         append(walls.data(), walls.size() * sizeof(blockid_t));
+         append(types.data(), types.size() * sizeof(int));
+         append(heights.data(), heights.size() * sizeof(int));
+      }
+
+      writeValue(file, legacyBandRows);
+      writeValue(file, bandCount);
+      size_t offset = 0;
+      for (const std::vector<char> &band: bands) {
+         writeValue(file, offset);
+         offset += band.size();
+      }
+      writeValue(file, offset);
+      for (const std::vector<char> &band: bands) {
+         file.write(band.data(), band.size());
+      }
+   } else {
+      int area = map.sizeX * map.sizeY;
+      std::vector<blockid_t> blocks = getLegacyRuns<blockid_t>(0, area, getBlock);
+      std::vector<blockid_t> walls = getLegacyRuns<blockid_t>(0, area, getWall);
+      std::vector<int> types = getLegacyRuns<int>(0, area, getLiquidType);
+      std::vector<int> heights = getLegacyRuns<int>(0, area, getLiquidHeight);
+
+      writeValue(file, blocks.size());
+      writeValue(file, walls.size());
+      writeRuns(file, blocks);
+      writeRuns(file, walls);
+      writeValue(file, types.size());
+      writeValue(file, heights.size());
+      writeRuns(file, types);
+      writeRuns(file, heights);
+   }
+
+   if (version >= 15) {
+      file.write(reinterpret_cast<const char*>(map.biomes.data()), map.biomes.size() * sizeof(BiomeColumn));
+   }
+   writeValue<size_t>(file, 0); // furniture
+   writeValue<size_t>(file, 0); // dropped items
+}
+
+// versions 17 and 18 had the bands of today one after another behind an index of where each starts, with everything
+// else around them in a fixed order. version 17 also had block IDs in its palette instead of names. so a world saved
+// now has its directory taken apart and put back together the old way
+static bool convertToIndexedVersion(const std::string &filename, int version) {
+   std::ifstream in (filename, std::ios::binary);
+   std::vector<char> data ((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+   in.close();
+
+   size_t offset = sizeof(int);
+   auto read = [&](void *out, size_t bytes) {
+      if (bytes > data.size() - offset) {
+         return false;
+      }
+      std::memcpy(out, data.data() + offset, bytes);
+      offset += bytes;
+      return true;
+   };
+   auto skipStrings = [&](std::vector<std::string> *strings) {
+      uint64_t count = 0;
+      if (!read(&count, sizeof(count))) {
+         return false;
+      }
+      for (uint64_t i = 0; i < count; ++i) {
+         uint64_t size = 0;
+         if (!read(&size, sizeof(size)) || size > data.size() - offset) {
+            return false;
+         }
+         if (strings) {
+            strings->emplace_back(data.data() + offset, size);
+         }
+         offset += size;
+      }
+      return true;
+   };
+
+   // the directory starts with the header, the inventory and the console history, which stay as they are
+   uint64_t directoryOffset = 0;
+   if (!read(&directoryOffset, sizeof(directoryOffset)) || directoryOffset > data.size()) {
+      return false;
+   }
+   offset = directoryOffset + headerSize + realInventorySlots * sizeof(Item);
+   if (!skipStrings(nullptr)) {
+      return false;
+   }
+   size_t paletteBegin = offset;
+
+   std::vector<std::string> paletteNames;
+   int bandRows = 0, bandCount = 0;
+   if (!skipStrings(&paletteNames) || !read(&bandRows, sizeof(bandRows)) || !read(&bandCount, sizeof(bandCount)) || bandCount < 0) {
+      return false;
+   }
+   size_t paletteEnd = offset - 2 * sizeof(int);
+
+   std::vector<uint64_t> bandOffsets (bandCount), bandSizes (bandCount);
+   if (!read(bandOffsets.data(), bandCount * sizeof(uint64_t)) || !read(bandSizes.data(), bandCount * sizeof(uint64_t))) {
+      return false;
+   }
+   size_t restBegin = offset;
+
+   std::ofstream out (filename, std::ios::binary);
+   std::memcpy(data.data() + directoryOffset, &version, sizeof(version));
+   out.write(data.data() + directoryOffset, paletteBegin - directoryOffset);
+
+   if (version == 17) {
+      writeValue<uint32_t>(out, paletteNames.size());
+      for (const std::string &name: paletteNames) {
+         writeValue<blockid_t>(out, getBlockIdFromName(name));
+      }
+   } else {
+      out.write(data.data() + paletteBegin, paletteEnd - paletteBegin);
+   }
+
+   writeValue(out, bandRows);
+   writeValue(out, bandCount);
+   uint64_t bandOffset = 0;
+   for (int band = 0; band < bandCount; ++band) {
+      writeValue(out, bandOffset);
+      bandOffset += bandSizes[band];
+   }
+   writeValue(out, bandOffset);
+   for (int band = 0; band < bandCount; ++band) {
+      if (bandOffsets[band] > data.size() || bandSizes[band] > data.size() - bandOffsets[band]) {
+         return false;
+      }
+      out.write(data.data() + bandOffsets[band], bandSizes[band]);
+   }
+
+   // the biomes, furniture and dropped items are the same as they were and end the file
+   out.write(data.data() + restBegin, data.size() - restBegin);
+   return true;
+}
+
+int main(int argc, char **argv) {
+   bool check = (argc > 1 && std::strcmp(argv[1], "--check") == 0);
+   int iterations = (check ? 1 : benchIterations);
+   int sizeCount = (check ? 1 : std::size(worldSizes));
+   int seedCount = (check ? 1 : std::size(seeds));
+
+   loadData(true);
+   std::error_code error;
+   std::filesystem::create_directories("data/worlds", error);
+   std::string filename = std::string("data/worlds/") + benchWorldName + ".bin";
+   std::vector<std::string> results, upgrades, incrementals;
+   bool allSame = true;
+
+   for (int sizeIndex = 0; sizeIndex < sizeCount; ++sizeIndex) {
+      for (int seedIndex = 0; seedIndex < seedCount; ++seedIndex) {
+         const int *size = worldSizes[sizeIndex];
+         uint64_t seed = seeds[seedIndex];
+         std::mutex infoTextMutex;
+         std::string infoText;
+         float progress = 0.0f;
+
+         MapGenerator generator (benchWorldName, size[0], size[1], false, seed, infoTextMutex, infoText, progress);
+         generator.generate();
+         const Map &map = generator.map;
+
+         double saveMs = measure(iterations, [&]() {
+            saveWorldData(benchWorldName, {}, {}, false, 100, 100, 100, 50.f, 0.0f, 0, map, nullptr, nullptr, nullptr);
+         });
+         size_t fileSize = std::filesystem::file_size(filename);
+
+         bool same = false;
+         double loadMs = measure(iterations, [&]() {
+            same = loadAndCompare(map, true);
+         });
+         allSame &= same;
+
+         size_t legacySize = getLegacyMapSize(map);
+         char result[256];
+         snprintf(result, sizeof(result), "%5dx%-5d seed %-3llu %9zuB %9zuB %7.2fx %8.2fms %8.2fms  %s", size[0], size[1], (unsigned long long)seed, fileSize, legacySize, legacySize / (double)fileSize, saveMs, loadMs, (same ? "ok" : "MISMATCH"));
+         results.push_back(result);
+
+         // then the same world from every older layout. version 13 didn't save the seed
+         for (int version: legacyVersions) {
+            if (version >= 17) {
+               saveWorldData(benchWorldName, {}, {}, false, 100, 100, 100, 50.f, 0.0f, 0, map, nullptr, nullptr, nullptr);
+               same = convertToIndexedVersion(filename, version);
+            } else {
+               writeLegacyWorld(filename, version, map);
+               same = true;
+            }
+            same = same && getFileVersion(benchWorldName) == version && loadAndCompare(map, version >= 14);
+            allSame &= same;
+
+            snprintf(result, sizeof(result), "%5dx%-5d seed %-3llu version %d  %s", size[0], size[1], (unsigned long long)seed, version, (same ? "ok" : "MISMATCH"));
+            upgrades.push_back(result);
+         }
+
+         // then the world loaded with a cache and saved over and over with a row changed each time, like autosaves.
+         // the changed bands are appended until too much of the file is dead and it's rewritten
+         saveWorldData(benchWorldName, {}, {}, false, 100, 100, 100, 50.f, 0.0f, 0, map, nullptr, nullptr, nullptr);
+         Map edited;
+         Player player;
+         Console console;
+         Inventory inventory;
+         std::vector<DroppedItem> droppedItems;
+         WorldBands cache;
+         float zoom = 0.0f;
+         same = loadWorldData(benchWorldName, player, zoom, edited, console, inventory, droppedItems, nullptr, &cache);
+
+         int appends = 0, rewrites = 0;
+         uint64_t appendedSize = 0, largestSize = 0;
+         for (int save = 0; save < incrementalSaves && same; ++save) {
+            int y = (save * 97 + 13) % edited.sizeY;
+            for (int x = 0; x < edited.sizeX; ++x) {
+               Block &block = edited.blocks[y * edited.sizeX + x];
+               if (block.tile == TileType::root) {
+                  block.id = (save % 2 == 0 ? getBlockIdFromName("stone") : 0);
+               }
+            }
+            cache.markDirty(y, y + 1);
+
+            uint64_t previousSize = cache.fileSize;
+            saveWorldData(benchWorldName, {}, {}, false, 100, 100, 100, 50.f, 0.0f, 0, edited, nullptr, nullptr, nullptr, &cache);
+            uint64_t savedSize = std::filesystem::file_size(filename);
+            if (cache.deadSize == 0) {
+               rewrites += 1;
+            } else {
+               appends += 1;
+               appendedSize += savedSize - previousSize;
+            }
+            largestSize = std::max(largestSize, savedSize);
+            same = loadAndCompare(edited, true) && savedSize == cache.fileSize;
+         }
+         allSame &= same && appends > 0 && rewrites > 0;
+
+         snprintf(result, sizeof(result), "%5dx%-5d seed %-3llu %9zuB %5d %9lluB %5d %9lluB  %s", size[0], size[1], (unsigned long long)seed, fileSize, appends, (unsigned long long)(appends ? appendedSize / appends : 0), rewrites, (unsigned long long)largestSize, (same ? "ok" : "MISMATCH"));
+         incrementals.push_back(result);
+      }
+   }
+   deleteWorld(benchWorldName);
+
+   printf("\nVersion %d files against the map section of version 16 alone, %d iterations each:\n", getLatestVersion(), iterations);
+   printf("%-22s %10s %10s %8s %10s %10s  %s\n", "world", "file", "v16 map", "ratio", "save", "load", "round trip");
+   for (const std::string &result: results) {
+      printf("%s\n", result.c_str());
+   }
+
+   printf("\nOlder versions upgraded to version %d:\n", getLatestVersion());
+   for (const std::string &upgrade: upgrades) {
+      printf("%s\n", upgrade.c_str());
+   }
+
+   printf("\nSaves of %d changed rows, appended to the file or rewriting it once too much of it is dead:\n", incrementalSaves);
+   printf("%-22s %10s %5s %10s %5s %10s  %s\n", "world", "full file", "adds", "avg added", "full", "largest", "round trip");
+   for (const std::string &incremental: incrementals) {
+      printf("%s\n", incremental.c_str());
+   }
+   return (allSame ? 0 : 1);
+}
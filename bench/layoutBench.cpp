@@ -0,0 +1,122 @@
+#include "objs/map.hpp"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+// Compares scan throughput of the old array-of-structs Block against the hot/cold lanes Map uses now. The scans mimic
+// what the renderer, Map::is and the physics loop read per tile.
+
+// Constants
+
+constexpr int mapSizeX = 2000;
+constexpr int mapSizeY = 750;
+constexpr int iterations = 50;
+
+// the layout Block had before the split
+struct PackedBlock {
+   blockid_t id = 0;
+   furnitureid_t ghostId = 0;
+   TileType tile = TileType::root;
+   BlockType type = BlockType::empty | BlockType::translucent | BlockType::flowable;
+   unsigned short value = 0;
+   unsigned short value2 = 0;
+   bool platformOverride = false;
+};
+
+// Fill functions
+
+static BlockType getTypeForDepth(int y, int x) {
+   if (y < mapSizeY / 3) {
+      return BlockType::empty | BlockType::translucent | BlockType::flowable;
+   } else if (y == mapSizeY / 3) {
+      return BlockType::solid | BlockType::grass;
+   } else if (y < mapSizeY / 2) {
+      return ((x * 7 + y * 13) % 29 == 0 ? BlockType::sand : BlockType::solid | BlockType::dirt);
+   }
+   return BlockType::solid;
+}
+
+static blockid_t getIdForType(BlockType type) {
+   return static_cast<blockid_t>(static_cast<unsigned short>(type) & 0xff);
+}
+
+// Scan functions. each returns a checksum so the compiler can't throw the loops away
+
+template<class T>
+static long long scanRuns(const std::vector<T> &blocks) {
+   long long runs = 0;
+   for (int y = 0; y < mapSizeY; ++y) {
+      blockid_t last = 0;
+      for (int x = 0; x < mapSizeX; ++x) {
+         const T &block = blocks[y * mapSizeX + x];
+         if (block.tile != TileType::root || BlockTypeHas(block.type, BlockType::empty)) {
+            continue;
+         }
+         runs += (block.id != last);
+         last = block.id;
+      }
+   }
+   return runs;
+}
+
+template<class T>
+static long long scanSolid(const std::vector<T> &blocks) {
+   long long solid = 0;
+   for (const T &block: blocks) {
+      solid += (block.tile == TileType::root && BlockTypeHas(block.type, BlockType::solid));
+   }
+   return solid;
+}
+
+template<class T>
+static long long scanPhysics(const std::vector<T> &blocks) {
+   long long active = 0;
+   for (int y = mapSizeY - 1; y >= 0; --y) {
+      for (int x = mapSizeX - 1; x >= 0; --x) {
+         BlockType type = blocks[y * mapSizeX + x].type;
+         active += BlockTypeHas(type, BlockType::sand | BlockType::grass | BlockType::dirt | BlockType::torch);
+      }
+   }
+   return active;
+}
+
+template<class Function>
+static void runScan(const char *name, size_t bytes, Function function) {
+   long long checksum = 0;
+   auto begin = std::chrono::steady_clock::now();
+
+   for (int i = 0; i < iterations; ++i) {
+      checksum += function();
+   }
+   auto end = std::chrono::steady_clock::now();
+   double ms = std::chrono::duration<double, std::milli>(end - begin).count() / iterations;
+   double tilesPerSecond = (mapSizeX * mapSizeY) / (ms / 1000.0);
+   printf("  %-10s %8.3fms/scan %10.1fM tiles/s %8.2fMB touched (checksum %lld)\n", name, ms, tilesPerSecond / 1000000.0, bytes / 1000000.0, checksum);
+}
+
+int main() {
+   const int area = mapSizeX * mapSizeY;
+   std::vector<PackedBlock> packed (area);
+   std::vector<Block> blocks (area);
+
+   for (int y = 0; y < mapSizeY; ++y) {
+      for (int x = 0; x < mapSizeX; ++x) {
+         BlockType type = getTypeForDepth(y, x);
+         int i = y * mapSizeX + x;
+         packed[i] = {getIdForType(type), 0, TileType::root, type};
+         blocks[i] = {getIdForType(type), type, TileType::root};
+      }
+   }
+
+   printf("Scanning a %dx%d map, %d iterations per scan.\n", mapSizeX, mapSizeY, iterations);
+   printf("Packed layout (%zuB per block):\n", sizeof(PackedBlock));
+   runScan("runs", packed.size() * sizeof(PackedBlock), [&]() { return scanRuns(packed); });
+   runScan("solid", packed.size() * sizeof(PackedBlock), [&]() { return scanSolid(packed); });
+   runScan("physics", packed.size() * sizeof(PackedBlock), [&]() { return scanPhysics(packed); });
+
+   printf("Hot lane (%zuB per block, %zuB cold state kept apart):\n", sizeof(Block), sizeof(BlockState));
+   runScan("runs", blocks.size() * sizeof(Block), [&]() { return scanRuns(blocks); });
+   runScan("solid", blocks.size() * sizeof(Block), [&]() { return scanSolid(blocks); });
+   runScan("physics", blocks.size() * sizeof(Block), [&]() { return scanPhysics(blocks); });
+   return 0;
+}
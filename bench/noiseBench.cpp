@@ -0,0 +1,66 @@
+#include "mngr/noise.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// Compares the batched noise kernels against one siv::PerlinNoise::octave2D call per tile, over the same map sized
+// area and with the same scales the debris and ore passes use
+
+// Constants
+
+constexpr int mapSizeX = 2000;
+constexpr int mapSizeY = 750;
+constexpr int octaves = 3;
+constexpr int iterations = 5;
+constexpr float scales[] = {0.05f, 0.1f, 0.125f};
+
+// Fill functions
+
+static void fillScalar(const siv::PerlinNoise &noise, float scale, std::vector<float> &out) {
+   for (int y = 0; y < mapSizeY; ++y) {
+      for (int x = 0; x < mapSizeX; ++x) {
+         out[y * mapSizeX + x] = noise.octave2D(x * scale, y * scale, octaves);
+      }
+   }
+}
+
+static void fillBatch(const siv::PerlinNoise &noise, float scale, std::vector<float> &out, NoiseKernel kernel) {
+   octave2DBlock(noise, 0, 0, mapSizeX, mapSizeY, scale, octaves, out.data(), kernel);
+}
+
+template<class Function>
+static double measure(Function function) {
+   auto begin = std::chrono::steady_clock::now();
+   for (int i = 0; i < iterations; ++i) {
+      function();
+   }
+   auto end = std::chrono::steady_clock::now();
+   return std::chrono::duration<double, std::milli>(end - begin).count() / iterations;
+}
+
+int main() {
+   const siv::PerlinNoise noise (12345u);
+   std::vector<float> expected (mapSizeX * mapSizeY), result (mapSizeX * mapSizeY);
+
+   printf("Filling %dx%d tiles with %d octaves, %d iterations each. best kernel is %s.\n", mapSizeX, mapSizeY, octaves, iterations, getNoiseKernelName(getNoiseKernel()));
+   for (float scale: scales) {
+      double scalarMs = measure([&]() { fillScalar(noise, scale, expected); });
+      printf("scale %.3f:\n", scale);
+      printf("  %-8s %8.2fms %8.1fM tiles/s\n", "octave2D", scalarMs, mapSizeX * mapSizeY / (scalarMs * 1000.0));
+
+      for (int kernel = 0; kernel < (int)NoiseKernel::count; ++kernel) {
+         if (!isNoiseKernelSupported(NoiseKernel(kernel))) {
+            continue;
+         }
+         double ms = measure([&]() { fillBatch(noise, scale, result, NoiseKernel(kernel)); });
+
+         float maxDifference = 0.0f;
+         for (size_t i = 0; i < result.size(); ++i) {
+            maxDifference = std::max(maxDifference, std::abs(result[i] - expected[i]));
+         }
+         printf("  %-8s %8.2fms %8.1fM tiles/s %6.2fx (max difference %g)\n", getNoiseKernelName(NoiseKernel(kernel)), ms, mapSizeX * mapSizeY / (ms * 1000.0), scalarMs / ms, maxDifference);
+      }
+   }
+   return 0;
+}
@@ -1,7 +1,11 @@
 #pragma once
 #include "game/state.hpp"
+#include "mngr/autosave.hpp"
+#include "mngr/data.hpp"
+#include "mngr/fileio.hpp"
 #include "objs/console.hpp"
 #include "objs/inventory.hpp"
+#include "objs/physics.hpp"
 #include "objs/player.hpp"
 #include "ui/button.hpp"
 
@@ -21,28 +25,20 @@ struct GameState: public State {
    void updatePausing();
    void updateDying();
 
-   // Physics functions
-
-   bool handleLiquidToBlock(int x, int y, liquidid_t id);
-   void updateLiquid(int x, int y, liquidid_t id);
-
-   void updateSandPhysics(int x, int y);
-   void updateGrassPhysics(int x, int y);
-   void updateDirtPhysics(int x, int y);
-   void updateTorchPhysics(int x, int y);
-
    // Other
 
    void render() override;
    State* change() override;
 
    void calculateCameraBounds();
+   bool reloadConfigs(ConfigFile files);
    void pushDropTable(droptableid_t id);
    void pushPendingDroppedItems();
 
    // Members
 
    Map map;
+   Physics physics {map};
    Player player;
 
    Camera2D camera;
@@ -53,28 +49,29 @@ struct GameState: public State {
 
    Console console;
    Inventory inventory;
+   Autosave autosave;
+   WorldLoad worldLoad;
    Button continueButton, menuButton, pauseButton;
 
    std::vector<DroppedItem> droppedItems;
    std::string worldName;
    Phase phase = Phase::playing;
    Phase phaseBeforePausing = Phase::playing;
+   bool loadFailed = false;
 
    Furniture furniturePreview;
    furnitureid_t lastFurnitureId = 0;
    blockid_t oldBlockBelowPreview = 0;
    bool flippedPreviewX = false;
 
-   std::vector<int> liquidCounters;
-   int physicsCounter = 0;
-   int physicsTicks = 8;
-   int grassGrowSpeedMin = 100;
-   int grassGrowSpeedMax = 255;
-
    float deathTimer = 0.0f;
    float timeToRespawn = 10.0f;
    float maxPickupRange = 2.0f;
    float maxToolRange = 10.0f;
+   float worldLoadBudget = 2.0f; // milliseconds of every tick spent putting loaded bands into the map
+   int playerLoadMargin = 4;
+   float configCheckTimer = 0.0f;
+   float configCheckInterval = 0.5f; // seconds between checking the config files for changes
 
    // Assets
 
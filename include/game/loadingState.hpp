@@ -1,10 +1,11 @@
 #pragma once
 #include "game/state.hpp"
+#include "mngr/assetLoader.hpp"
 #include "raylib.h"
 #include <string>
 
 struct LoadingState: public State {
-   enum class Load { fonts, textures, shaders, sounds, music, data, count };
+   enum class Load { fonts, shaders, assets, music, data, count };
 
    LoadingState();
    ~LoadingState() = default;
@@ -21,6 +22,7 @@ struct LoadingState: public State {
    std::string loadingText = "Loading Fonts... ";
    Load loadPhase = Load::fonts;
 
+   AssetLoader assetLoader;
    float finalWaitTimer = 0.f;
    float iconRotation = 0.f;
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "game/state.hpp"
+#include "mngr/fileio.hpp"
 #include "ui/bar.hpp"
 #include "ui/button.hpp"
 #include "ui/checkbox.hpp"
@@ -47,6 +48,7 @@ struct MenuState: public State {
    void selectButton(Button &button);
 
    std::string generateRandomWorldName() const;
+   const WorldInfo *getWorldInfo(const std::string &name) const;
    bool isWorldFavorite(const std::string &name) const;
 
    // Helper functions
@@ -64,11 +66,12 @@ struct MenuState: public State {
 
    Rectangle worldFrame;
    CheckBox shouldWorldBeFlat;
-   Input worldName, worldSearchBar, renameInput;
+   Input worldName, worldSeed, worldSearchBar, renameInput;
    Bar generationProgressBar;
 
    std::vector<std::string> favoriteWorlds;
    std::vector<Button> worldButtons;
+   std::vector<WorldInfo> worldInfos; // the world index as of the last loadWorldButtons, sorted by name
    Rectangle worldFrameButtonRects[buttonsInWorldFrame];
 
    std::string selectedWorld, generationSplash, generationInfoText;
@@ -77,11 +80,11 @@ struct MenuState: public State {
    std::mutex generationInfoTextMutex;
    struct MapGenerator *generator;
    bool generatedWorld = true;
+   float generationDoneTimer = 0.0f;
 
    bool anySelected = false;
    bool deleteClicked = false;
    bool megaDeleteClicked = false;
-   bool invalidVersionClicked = false;
    bool wasFavoriteBeforeRenaming = false;
    bool playing = false;
 
@@ -0,0 +1,70 @@
+#pragma once
+#include "raylib.h"
+#include <string>
+#include <vector>
+
+// A texture, shader, sound or font looked up once by name. it points straight into SRU's storage or the game's own,
+// which both keep their assets in place, so using one every frame costs nothing. unresolved handles are null, like in
+// headless runs
+template<class T>
+struct AssetHandle {
+   T &operator*() const { return *asset; }
+   T *operator->() const { return asset; }
+   explicit operator bool() const { return asset != nullptr; }
+
+   T *asset = nullptr;
+};
+
+// A sound and its variants. files like click1.wav and click2.wav all go under click and playSound picks one of them at
+// random, like SRU does
+struct SoundVariants {
+   std::vector<Sound> sounds;
+};
+
+using TextureHandle = AssetHandle<Texture>;
+using ShaderHandle = AssetHandle<Shader>;
+using SoundHandle = AssetHandle<SoundVariants>;
+using FontHandle = AssetHandle<Font>;
+
+// Every asset the game reaches for while it's running, filled in by resolveAssetHandles once loading is done
+struct AssetHandles {
+   FontHandle font;
+
+   TextureHandle player, button, keybind, popupFrame, sky, stars, sun, moon;
+   TextureHandle lightHuge, lightLarge, light;
+   TextureHandle smallFrame, smallFrameSelected, smallFrameFavorite, smallFrameFavoriteSelected, smallFrameTrash;
+   ShaderHandle water, clip;
+
+   SoundHandle click, hover, typing, success, failure, notice, trash, openInventory, closeInventory;
+   SoundHandle jump, footstep, hurt, die, pickup;
+};
+
+// String lookups that are left, counted per frame so new ones in code that runs every frame show up. only meant for
+// the main thread
+struct AssetLookupCounter {
+   int frame = 0;
+   int lastFrame = 0;
+};
+
+// Textures and sounds the game loads itself instead of through SRU, like the ones the asset loader decodes. SRU only
+// registers assets it reads from a path, so these are kept here and texture lookups check them before asking SRU.
+// adding a texture that is already there unloads the old one first, so handles to it stay valid. sounds are added as
+// another variant of their name
+Texture &addTexture(const std::string &name, Texture texture);
+SoundVariants &addSound(const std::string &name, Sound sound);
+std::string getSoundName(const std::string &filename);
+bool hasTexture(const std::string &name);
+bool hasSound(const std::string &name);
+
+void resolveAssetHandles();
+const AssetHandles &getAssetHandles();
+
+Texture &lookupTexture(const std::string &name);
+Shader &lookupShader(const std::string &name);
+SoundVariants &lookupSound(const std::string &name);
+Font &lookupFont(const std::string &name);
+
+void playSound(SoundHandle sound, float volume = 1.0f);
+
+AssetLookupCounter &getAssetLookupCounter();
+void endAssetLookupFrame();
@@ -0,0 +1,47 @@
+#pragma once
+#include "raylib.h"
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// An image or sound decoded into memory, waiting to be uploaded on the main thread
+struct DecodedAsset {
+   enum class Kind {texture, sound};
+
+   std::string name, path;
+   Kind kind = Kind::texture;
+   Image image {};
+   Wave wave {};
+   float decodeMs = 0.0f;
+};
+
+// Decodes every image and sound in a few folders into memory on the thread pool, from a thread of its own so the
+// loading screen keeps drawing. upload turns whatever is decoded into textures and sounds on the main thread, as many
+// as fit into its budget. decoding never touches the window or the audio device, so it also runs headless
+struct AssetLoader {
+   AssetLoader() = default;
+   ~AssetLoader();
+   AssetLoader(const AssetLoader&) = delete;
+   AssetLoader &operator=(const AssetLoader&) = delete;
+
+   void addFolder(const std::string &directory, DecodedAsset::Kind kind);
+   void start();
+   void decode();
+   void wait();
+
+   bool upload(float budget);
+   void printDecodeTimes() const;
+
+   // Members
+
+   std::vector<DecodedAsset> assets;
+   std::deque<int> decoded; // indices into assets, filled by the decoding thread and guarded by mutex
+   std::mutex mutex;
+   std::thread thread;
+
+   bool parallel = true;
+   int uploaded = 0;
+   float decodeMs = 0.0f; // wall time of the whole decode
+};
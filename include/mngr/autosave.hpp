@@ -0,0 +1,52 @@
+#pragma once
+#include "mngr/fileio.hpp"
+#include "objs/console.hpp"
+#include "objs/inventory.hpp"
+#include "objs/player.hpp"
+#include <atomic>
+#include <thread>
+
+// Autosave. every interval seconds the parts of the world that go into the file are copied between two ticks, then
+// written from a background thread while the game keeps going. the copy of the map is kept from one autosave to the
+// next and only chunks marked dirty since the last snapshot are copied into it, so a snapshot costs about as much as
+// what changed in the world. the bands of the file those chunks fall in are the only ones encoded again and appended
+// to the file, the rest stays where the last save or the load left it. autosave consumes the map's dirty bits, so the save on exit goes through it too
+
+struct Autosave {
+   Autosave() = default;
+   ~Autosave();
+   Autosave(const Autosave&) = delete;
+   Autosave &operator=(const Autosave&) = delete;
+
+   void init(const std::string &worldName, const Map &map);
+   void update(float dt, const Player &player, float zoom, Map &map, const Console &console, const Inventory &inventory, const std::vector<DroppedItem> &droppedItems);
+
+   void takeSnapshot(const Player &player, float zoom, Map &map, const Console &console, const Inventory &inventory, const std::vector<DroppedItem> &droppedItems);
+   void copyChunk(const Map &map, int chunkX, int chunkY, ChunkFlag flags);
+   void save();
+   void wait();
+
+   // Members
+
+   // the snapshot. only the parts of the map that get saved are filled in
+   Map map;
+   Console console;
+   Inventory inventory;
+   std::vector<DroppedItem> droppedItems;
+   Vector2 spawnPosition {}, position {};
+   bool creative = false;
+   int breath = 0, hearts = 0, maxHearts = 0;
+   float zoom = 0.0f, timeOfDay = 0.0f;
+   int moonPhase = 0;
+
+   WorldBands bands;
+   std::string worldName;
+   std::thread thread;
+   std::atomic<bool> saving {false};
+
+   float interval = 300.0f; // seconds between autosaves, 0 or less turns them off
+   float timer = 0.0f;
+   float snapshotMs = 0.0f, saveMs = 0.0f; // time the last autosave spent copying the world and writing it
+   float threadSaveMs = 0.0f; // written by the save thread, copied into saveMs once it's joined
+   int chunksCopied = 0;
+};
@@ -1,7 +1,29 @@
 #pragma once
 #include "SRU/file.hpp"
 
-void loadData();
+// config files
+
+enum class ConfigFile: unsigned char {
+   none       = 0,
+   blocks     = 1 << 0,
+   liquids    = 1 << 1,
+   furniture  = 1 << 2,
+   items      = 1 << 3,
+   dropTables = 1 << 4,
+   all        = blocks | liquids | furniture | items | dropTables,
+};
+
+constexpr inline ConfigFile operator | (ConfigFile lhs, ConfigFile rhs) {
+   return static_cast<ConfigFile>(static_cast<unsigned char>(lhs) | static_cast<unsigned char>(rhs));
+}
+
+constexpr inline bool ConfigFileHas(ConfigFile lhs, ConfigFile rhs) {
+   return (static_cast<unsigned char>(lhs) & static_cast<unsigned char>(rhs)) != 0;
+}
+
+void loadData(bool headless = false);
+ConfigFile getChangedConfigFiles();
+ConfigFile reloadData(ConfigFile files);
 void loadPrepass(std::vector<Header> &blockHeaders, std::vector<Header> &liquidHeaders, std::vector<Header> &furnitureHeaders, std::vector<Header> &itemHeaders, std::vector<Header> &dropHeaders);
 
 void loadBlockData(std::vector<Header> &headers);
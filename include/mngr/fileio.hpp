@@ -1,10 +1,91 @@
 #pragma once
+#include "objs/map.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
-void saveWorldData(const std::string &name, const struct Vector2 &playerSpawnPosition, const struct Vector2 &position, bool creative, int breath, int hearts, int maxHearts, float zoom, const struct Map &map, const struct Console *console, const struct Inventory *inventory, const std::vector<struct DroppedItem> *droppedItems);
-void loadWorldData(const std::string &name, struct Player &player, float &zoom, struct Map &map, struct Console &console, struct Inventory &inventory, std::vector<struct DroppedItem> &droppedItems);
+// Columns in the thumbnail of a world
+constexpr int worldThumbnailWidth = 64;
+
+// What the menu shows about a world. every world has one in the world index, which is kept up to date by saving,
+// renaming and deleting, so listing worlds never has to open them
+struct WorldInfo {
+   std::string name;
+   int version = 0;
+   int sizeX = 0, sizeY = 0;
+   int64_t lastPlayed = 0; // unix time of the last save
+   uint64_t fileSize = 0;
+   std::array<uint8_t, worldThumbnailWidth> thumbnail {}; // height of the surface across the world, 255 at the top. all 0 if it's unknown
+};
+
+// Encoded map bands kept from one save of a world to the next, filled in by loading the world or by saving it. saves
+// given one only encode the bands marked dirty since, append just those to the file with a new directory after them
+// and leave the others where they are. the copies they replace are dead space until the file is compacted, which
+// rewrites it whole once too much of it is dead. the bands refer to blocks by their index in the palette
+struct WorldBands {
+   void markDirty(int minY, int maxY);
+
+   std::vector<std::vector<char>> bands;
+   std::vector<bool> dirty;
+   std::vector<blockid_t> palette;
+
+   // the file the bands are in, as the last save or load left it. an empty offsets means the next save rewrites it
+   std::vector<uint64_t> offsets;
+   uint64_t fileSize = 0, directorySize = 0, deadSize = 0;
+};
+
+// The tiles of one band of rows decoded away from the map, waiting to be put into it
+struct DecodedBand {
+   int band = 0;
+   std::vector<Block> blocks;
+   std::vector<Wall> walls;
+   std::vector<liquidid_t> liquidTypes;
+   std::vector<liquidlayer_t> liquidHeights;
+};
+
+// A world loaded a bit at a time. loadWorldData given one only decodes the bands around the player before returning
+// and leaves the others to a background thread, nearest first. publish puts the bands that thread finished into the
+// map between ticks, their chunks count as unloaded until then
+struct WorldLoad {
+   WorldLoad() = default;
+   ~WorldLoad();
+   WorldLoad(const WorldLoad&) = delete;
+   WorldLoad &operator=(const WorldLoad&) = delete;
+
+   bool publish(Map &map, float budget);
+   void finish(Map &map);
+   void publishBand(Map &map, DecodedBand &band);
+   void updateChunks(Map &map, int minY, int maxY);
+
+   bool areRowsLoaded(int minY, int maxY) const;
+   bool isDone() const;
+
+   // Members
+
+   std::deque<DecodedBand> decoded; // filled by the thread, guarded by mutex
+   std::vector<Furniture> furniture; // placed once all of their rows are in
+   std::vector<bool> bandsLoaded;
+   std::mutex mutex;
+   std::thread thread;
+   std::atomic<bool> cancelled {false};
+
+   int bandRows = 0;
+   int bandsLeft = 0;
+};
+
+void saveWorldData(const std::string &name, const struct Vector2 &playerSpawnPosition, const struct Vector2 &position, bool creative, int breath, int hearts, int maxHearts, float zoom, float timeOfDay, int moonPhase, const struct Map &map, const struct Console *console, const struct Inventory *inventory, const std::vector<struct DroppedItem> *droppedItems, WorldBands *cache = nullptr);
+bool loadWorldData(const std::string &name, struct Player &player, float &zoom, struct Map &map, struct Console &console, struct Inventory &inventory, std::vector<struct DroppedItem> &droppedItems, WorldLoad *progressive = nullptr, WorldBands *cache = nullptr);
 bool deleteWorld(const std::string &name);
+bool renameWorld(const std::string &name, const std::string &newName);
+bool upgradeWorld(const std::string &name);
+
+std::vector<WorldInfo> getWorldIndex();
+void syncWorldIndex();
 
 int getFileVersion(const std::string &name);
 int getLatestVersion();
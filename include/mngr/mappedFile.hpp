@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Read-only view of a whole file mapped into memory. data stays nullptr if the file couldn't be opened, mapped or is
+// empty. kept out of raylib's headers since windows.h and raylib don't get along
+
+struct MappedFile {
+   MappedFile(const std::string &filename);
+   ~MappedFile();
+   MappedFile(const MappedFile&) = delete;
+   MappedFile &operator=(const MappedFile&) = delete;
+
+   // Members
+
+   const char *data = nullptr;
+   size_t size = 0;
+   void *fileHandle = nullptr; // only used on windows
+   void *mappingHandle = nullptr;
+};
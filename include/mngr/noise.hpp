@@ -0,0 +1,19 @@
+#pragma once
+#include "PerlinNoise.hpp"
+
+// Batched noise. fills a row of tiles with the same values siv::PerlinNoise::octave2D gives for (x * scale, y * scale)
+// with a float scale, with the default persistence. the lattice hashing and gradients are worked out once per noise
+// cell instead of once per tile, and the rest runs on SIMD lanes. every kernel does the same operations in the same
+// order as the scalar calls, so the results match them exactly
+
+enum class NoiseKernel { scalar, sse2, avx2, count };
+
+bool isNoiseKernelSupported(NoiseKernel kernel);
+NoiseKernel getNoiseKernel(); // the fastest supported kernel
+const char *getNoiseKernelName(NoiseKernel kernel);
+
+// out[i] is noise.octave2D((x + i) * scale, y * scale, octaves), for i from 0 to count - 1
+void octave2DRow(const siv::PerlinNoise &noise, int x, int y, int count, float scale, int octaves, float *out, NoiseKernel kernel = getNoiseKernel());
+
+// width * height values, row after row
+void octave2DBlock(const siv::PerlinNoise &noise, int x, int y, int width, int height, float scale, int octaves, float *out, NoiseKernel kernel = getNoiseKernel());
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+
+// Stateless random functions. unlike SRU's random functions these don't share a generator, so they can be called from
+// any thread and give the same answer for the same input no matter in which order they're called
+
+constexpr uint64_t mixBits(uint64_t value) {
+   // splitmix64 finalizer
+   value += 0x9e3779b97f4a7c15ull;
+   value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+   value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+   return value ^ (value >> 31);
+}
+
+constexpr uint64_t hashCell(int x, int y, uint64_t salt) {
+   return mixBits(salt ^ mixBits((uint64_t(uint32_t(x)) << 32) | uint32_t(y)));
+}
+
+// percent is out of 100, like chance()
+constexpr bool cellChance(int x, int y, uint64_t salt, int percent) {
+   return int(hashCell(x, y, salt) % 100) < percent;
+}
+
+// min and max are inclusive, like randomInt()
+constexpr int cellRandomInt(int x, int y, uint64_t salt, int min, int max) {
+   return min + int(hashCell(x, y, salt) % uint64_t(max - min + 1));
+}
+
+// Seeded random stream. a stream only depends on the seed and its own index, so every pass of the world generator can
+// draw from its own stream and the result won't change when another pass starts drawing more or fewer numbers
+
+struct RandomStream {
+   RandomStream(uint64_t seed, uint64_t stream)
+      : state(mixBits(seed ^ mixBits(stream))) {}
+
+   uint64_t next() {
+      state += 0x9e3779b97f4a7c15ull;
+      return mixBits(state);
+   }
+
+   // min and max are inclusive, like randomInt()
+   int randomInt(int min, int max) {
+      return (max <= min ? min : min + int(next() % uint64_t(int64_t(max) - min + 1)));
+   }
+
+   float randomFloat(float min, float max) {
+      return min + (max - min) * (float(next() >> 40) / float(1 << 24));
+   }
+
+   // percent is out of 100, like chance()
+   bool chance(int percent) {
+      return int(next() % 100) < percent;
+   }
+
+   template<class Container>
+   auto &randomElement(Container &container) {
+      return container[randomInt(0, int(container.size()) - 1)];
+   }
+
+   uint64_t state = 0;
+};
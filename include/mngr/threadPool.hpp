@@ -0,0 +1,45 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Thread pool
+
+struct ThreadPool {
+   ThreadPool(int workerCount);
+   ~ThreadPool();
+   ThreadPool(const ThreadPool&) = delete;
+   ThreadPool &operator=(const ThreadPool&) = delete;
+
+   // runs function(0) to function(count - 1) spread over the workers and the calling thread, returns once all are done.
+   // one batch runs at a time, if another thread already has one going the calling thread does all of it by itself
+   void run(int count, const std::function<void(int)> &function);
+   int getThreadCount() const;
+
+   // Members
+
+   struct Batch {
+      const std::function<void(int)> *function = nullptr;
+      int count = 0;
+      int active = 0; // workers currently inside this batch, guarded by the mutex
+      std::atomic<int> next {0};
+      std::atomic<int> done {0};
+   };
+
+   void workerLoop();
+   void work(Batch &batch);
+
+   std::vector<std::thread> workers;
+   std::mutex mutex, runMutex;
+   std::condition_variable wakeCondition, doneCondition;
+   Batch *batch = nullptr;
+   unsigned long long generation = 0;
+   bool stopping = false;
+};
+
+// Getter functions
+
+ThreadPool &getThreadPool();
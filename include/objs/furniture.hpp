@@ -67,6 +67,7 @@ size_t getFurnitureCount();
 
 void reserveFurnitureContainers(size_t estimate);
 void pushFurniture(const std::string &name);
+void clearFurnitureSoils();
 void setFurniture(const std::string &name, FurnitureData data, const std::vector<blockid_t> &saplingSoils, const std::vector<blockid_t> &treeSoils);
 
 // furniture
@@ -78,7 +79,7 @@ struct Furniture {
    bool isSuitableForPlant(const struct Map &map, FurnitureData &data, bool previewing) const;
 
    bool setSimpleFurniture(const struct Map &map, FurnitureData &data, bool playerFacingLeft, bool walkable, bool previewing);
-   bool setPlant(const struct Map &map, FurnitureData &data, bool previewing);
+   bool setPlant(const struct Map &map, FurnitureData &data, bool previewing, struct RandomStream &random);
 
    // Update functions
 
@@ -111,5 +112,5 @@ struct Furniture {
 
 // Furniture generation functions
 
-Furniture getFurniture(int x, int y, const struct Map &map, furnitureid_t id, bool playerFacingLeft, bool previewing = false);
-void generateFurniture(int x, int y, struct Map &map, furnitureid_t id, bool playerFacingLeft);
+Furniture getFurniture(int x, int y, const struct Map &map, furnitureid_t id, bool playerFacingLeft, bool previewing = false, struct RandomStream *random = nullptr);
+void generateFurniture(int x, int y, struct Map &map, furnitureid_t id, bool playerFacingLeft, struct RandomStream *random = nullptr);
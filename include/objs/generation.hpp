@@ -2,18 +2,28 @@
 #include "objs/map.hpp"
 #include "PerlinNoise.hpp"
 #include <atomic>
+#include <functional>
 #include <mutex>
 #include <string>
 
+// Seed functions
+
+uint64_t getRandomSeed();
+uint64_t getSeedFromString(const std::string &text);
+
+// Map generator
+
 struct MapGenerator {
-   enum class Biome { plains, forest, mountains, desert_oasis, desert, tundra, jungle, count };
+   using Biome = ::Biome;
    enum class BiomeWarmth { cold, warm, hot };
 
-   MapGenerator(const std::string &name, int sizeX, int sizeY, bool isFlat, std::mutex &infoTextMutex, std::string &infoText, float &progress);
+   MapGenerator(const std::string &name, int sizeX, int sizeY, bool isFlat, uint64_t seed, std::mutex &infoTextMutex, std::string &infoText, float &progress);
 
    // Generation functions
 
    void generate();
+   void generateBiomes();
+   void generateHeights();
    void generateTerrain();
    void generateWater();
    void generateDebri();
@@ -29,12 +39,14 @@ struct MapGenerator {
 
    // Getter functions
 
-   Biome getBiome(int x);
+   Biome getNoiseBiome(int x);
    float normalizedNoise1D(siv::PerlinNoise &noise, int x, float amplitude);
    float normalizedNoise2D(siv::PerlinNoise &noise, int x, int y, float amplitude);
 
    // Other functions
 
+   void runPass(const std::string &text, float progress, void (MapGenerator::*pass)());
+   void forEachStrip(const std::function<void(int minX, int maxX)> &function);
    void setInfo(const std::string &text, float progress);
 
    // Members
@@ -43,12 +55,16 @@ struct MapGenerator {
    std::string &infoText;
    float &progress;
 
+   // per column fields, filled in before the passes that write tiles. biomes go straight into map.biomes
+   std::vector<int> terrainHeights;
    std::vector<int> rockStartHeights;
+   std::vector<std::pair<std::string, double>> passTimes; // info text and milliseconds of every pass that ran
    std::string name;
    Map map;
 
    std::atomic<bool> isCompleted = false;
    bool isFlat = false;
+   uint64_t seed = 0;
 
    siv::PerlinNoise biomeTemperatureNoise;
    siv::PerlinNoise biomeMoistureNoise;
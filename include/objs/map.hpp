@@ -1,5 +1,6 @@
 #pragma once
 #include "objs/furniture.hpp"
+#include <cstdint>
 #include <unordered_map>
 
 // constants
@@ -9,6 +10,7 @@ constexpr inline liquidlayer_t maxLiquidLayers = 32;
 constexpr inline liquidlayer_t minLiquidLayers = maxLiquidLayers / 8;
 constexpr inline liquidlayer_t liquidToBlockThreshold = maxLiquidLayers / 8;
 constexpr inline liquidlayer_t playerLiquidThreshold = maxLiquidLayers / 2;
+constexpr inline int chunkSize = 32;
 
 // block
 
@@ -58,13 +60,19 @@ struct BlockData {
    int wallToolPower = 0;
    bool wallToolPowerRequired = false;
    ToolType wallToolType = ToolType::hammer;
+   blockid_t turnsInto = 0; // grass and dirt, what they become when covered or uncovered. 0 if they stay
 };
 
+// Blocks are split into two lanes. Block is what rendering, Map::is and the physics scan read for every tile, so it's
+// kept small. BlockState lives in a parallel array and is only touched by the few code paths that need it
 struct Block {
    blockid_t id = 0;
-   furnitureid_t ghostId = 0;
-   TileType tile = TileType::root;
    BlockType type = BlockType::empty | BlockType::translucent | BlockType::flowable;
+   TileType tile = TileType::root;
+};
+
+struct BlockState {
+   furnitureid_t ghostId = 0;
 
    // Values used by physics updates, specific to the block type
    unsigned short value = 0;
@@ -115,6 +123,54 @@ void reserveLiquidContainers(size_t estimate);
 void pushLiquid(const std::string &name);
 void setLiquid(const std::string &name, const LiquidData &data);
 
+// Chunks
+
+enum class ChunkFlag: unsigned char {
+   blocks  = 1 << 0,
+   walls   = 1 << 1,
+   liquids = 1 << 2,
+   all     = blocks | walls | liquids,
+};
+
+constexpr inline ChunkFlag operator | (ChunkFlag lhs, ChunkFlag rhs) {
+   return static_cast<ChunkFlag>(static_cast<unsigned char>(lhs) | static_cast<unsigned char>(rhs));
+}
+
+constexpr inline bool ChunkFlagHas(ChunkFlag lhs, ChunkFlag rhs) {
+   return (static_cast<unsigned char>(lhs) & static_cast<unsigned char>(rhs)) != 0;
+}
+
+// Tiles stay in the flat row-major arrays, chunks are a coarse grid over them that remembers what changed. Whoever
+// consumes the dirty bits (saving, lighting, render caches) is responsible for clearing them. chunks a progressive
+// load hasn't filled in yet are unloaded, physics and editing leave them alone until then
+struct MapChunk {
+   ChunkFlag dirty {};
+   bool loaded = true;
+};
+
+// Occupancy planes, one bit per tile and 64 tiles per word. each row starts on a fresh word. platform includes walkable
+// furniture, liquid is set for any liquid regardless of its height. awake marks cells the physics should visit
+
+enum class Plane {
+   solid,
+   platform,
+   empty,
+   liquid,
+   awake,
+   count,
+};
+
+// Biomes, one per column. the values are saved in world files, append new biomes at the end. near a border a column
+// also remembers the closest other biome and how much of it blends in, 0 away from borders up to 127 right next to one
+
+enum class Biome: unsigned char { plains, forest, mountains, desert_oasis, desert, tundra, jungle, count };
+
+struct BiomeColumn {
+   Biome biome = Biome::plains;
+   Biome blendBiome = Biome::plains;
+   unsigned char blend = 0;
+};
+
 // Map
 
 struct Map {   
@@ -125,10 +181,6 @@ struct Map {
 
    // setters
 
-   void setRow(int y, const std::string &name);
-   void setWallRow(int y, const std::string &name);
-   void setColumnFromPoint(int x, int y, const std::string &name);
-
    void fill(int i, int n, blockid_t id);
    void fillWalls(int i, int n, blockid_t id);
    void fillLiquids(int i, int n, liquidid_t id);
@@ -139,11 +191,26 @@ struct Map {
    void setWall(int x, int y, const std::string &name);
    void setWall(int x, int y, blockid_t id);
    void setLiquid(int x, int y, liquidid_t id, liquidlayer_t height);
+   void refreshBlockTypes();
+
+   // region writers. ids are resolved by the caller and the chunk flags, surface, planes and awake cells are updated
+   // once per region instead of once per tile. liquid regions replace the blocks in them, like placing liquid by hand
+   void setBlockRect(int x, int y, int width, int height, blockid_t id);
+   void setWallRect(int x, int y, int width, int height, blockid_t id);
+   void setLiquidRect(int x, int y, int width, int height, liquidid_t id, liquidlayer_t liquidHeight);
+   void setBlockColumn(int x, int y, int height, blockid_t id);
+   void setWallColumn(int x, int y, int height, blockid_t id);
+   void setBlockMask(int x, int y, uint64_t mask, const blockid_t *ids);
 
    void deleteBlock(int x, int y);
    void deleteWall(int x, int y);
    void deleteBlockWithoutDeletingLiquids(int x, int y);
    void swapBlocks(int oldX, int oldY, int newX, int newY);
+   void swapLiquids(int oldX, int oldY, int newX, int newY);
+
+   void updateTile(int x, int y, ChunkFlag flags);
+   void updateSpan(int i, int n, ChunkFlag flags);
+   void updateRect(int x, int y, int width, int height, ChunkFlag flags);
 
    // furniture
 
@@ -154,7 +221,9 @@ struct Map {
    // getters
 
    const Block &getBlock(int x, int y) const;
+   const BlockState &getBlockState(int x, int y) const;
    const Wall &getWall(int x, int y) const;
+   const BiomeColumn &getBiome(int x) const;
 
    bool isPositionValid(int x, int y) const;
    bool isPositionValid(Vector2 position) const;
@@ -174,6 +243,53 @@ struct Map {
    liquidid_t getLiquidId(int x, int y) const;
    LiquidData &getLiquidData(int x, int y) const;
 
+   // chunks
+
+   void markDirty(int x, int y, ChunkFlag flags);
+   void markDirtyArea(int x, int y, int width, int height, ChunkFlag flags);
+   void markDirtySpan(int i, int n, ChunkFlag flags);
+   void clearDirty(ChunkFlag flags);
+   void clearChunkDirty(int chunkX, int chunkY, ChunkFlag flags);
+
+   bool isChunkDirty(int chunkX, int chunkY, ChunkFlag flags) const;
+   bool anyChunkDirty(ChunkFlag flags) const;
+   MapChunk &getChunk(int x, int y);
+
+   void setChunkLoaded(int chunkX, int chunkY, bool loaded);
+   bool isLoaded(int x, int y) const;
+   bool isAreaLoaded(int x, int y, int width, int height) const;
+
+   // surface
+
+   int getSurfaceY(int x) const;
+   void updateSurface(int x, int y);
+   void updateSurfaceSpan(int i, int n);
+   void updateSurfaceRect(int x, int y, int width, int height);
+   void updateSurfaceRows(int minY, int maxY);
+   void rebuildSurface(int minX, int maxX);
+
+   // occupancy planes
+
+   void updatePlanes(int x, int y);
+   void setPlaneBit(Plane plane, int x, int y, bool value);
+   void setPlaneRange(Plane plane, int y, int minX, int maxX, bool value);
+   void setPlaneSpan(Plane plane, int i, int n, bool value);
+   void setPlaneRect(Plane plane, int x, int y, int width, int height, bool value);
+   void rebuildPlanes(int minY, int maxY);
+
+   bool testPlane(Plane plane, int x, int y) const;
+   uint64_t getPlaneBits(Plane plane, int x, int y, int count) const;
+   bool anyInSpan(Plane plane, int y, int minX, int maxX) const;
+   bool allInSpan(Plane plane, int y, int minX, int maxX) const;
+   int findLastInSpan(Plane plane, int y, int minX, int maxX) const;
+
+   // physics scheduling
+
+   void wake(int x, int y);
+   void wakeArea(int x, int y, int width, int height);
+   void keepAwake(int x, int y);
+   void sleep(int x, int y);
+
    // render
 
    void renderLight(const Camera2D &camera, Texture2D &texture, float x, float y, const Vector2 &size, const Color &color);
@@ -181,15 +297,25 @@ struct Map {
 
    // Members
 
-   RenderTexture lightmap;
+   RenderTexture lightmap {};
    std::vector<Block> blocks;
+   std::vector<BlockState> blockStates;
    std::vector<Wall> walls;
    std::vector<liquidlayer_t> liquidHeights;
    std::vector<liquidid_t> liquidTypes;
    std::vector<Furniture> furniture;
    std::vector<size_t> furnitureEmptySlots;
+   std::vector<MapChunk> chunks;
+   std::vector<int> surfaceHeights; // topmost non-empty block per column, sizeY if there's none
+   std::vector<BiomeColumn> biomes;
+   std::vector<uint64_t> planes[(int)Plane::count];
 
    int sizeX = 0;
    int sizeY = 0;
+   int chunksX = 0;
+   int chunksY = 0;
+   int planeWords = 0; // words per plane row
+   int unloadedChunks = 0;
    int waterTimeShaderLocation = 0;
+   uint64_t seed = 0; // world generation seed, 0 for worlds saved before seeds were stored
 };
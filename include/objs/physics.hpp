@@ -0,0 +1,56 @@
+#pragma once
+#include "objs/map.hpp"
+
+// Cellular physics for sand, liquids, grass, dirt and torches. doesn't touch the window, so it runs the same in the
+// game and headless
+
+struct Physics {
+   Physics(Map &map);
+   void init();
+
+   // Update
+
+   void fixedUpdate(const Rectangle &cameraBounds);
+   void updateNearPhysics(const Rectangle &cameraBounds);
+   void updateFarPhysics();
+
+   int updatePhysicsStrips(const std::vector<int> &strips, const Rectangle &bounds, const Rectangle *skip, const std::vector<int> &counters, unsigned long long tick);
+   int updatePhysicsStrip(int minX, int maxX, int minY, int maxY, const Rectangle *skip, const std::vector<int> &counters, unsigned long long tick);
+   void updatePhysicsCell(int x, int y, const std::vector<int> &counters, unsigned long long tick);
+
+   // Cell functions
+
+   bool handleLiquidToBlock(int x, int y, liquidid_t id);
+   void updateLiquid(int x, int y, liquidid_t id);
+
+   void updateSandPhysics(int x, int y, unsigned long long tick);
+   void updateGrassPhysics(int x, int y, unsigned long long tick);
+   void updateDirtPhysics(int x, int y, unsigned long long tick);
+   void updateTorchPhysics(int x, int y);
+
+   // Members
+
+   Map &map;
+
+   std::vector<int> liquidCounters;
+   int physicsCounter = 0;
+   int physicsTicks = 8;
+   int cellsUpdated = 0; // awake cells visited during the last physics tick
+   unsigned long long physicsTick = 0; // seeds the per-cell random numbers
+   bool parallelPhysics = true;
+   Rectangle physicsBounds {};
+
+   int grassGrowSpeedMin = 100;
+   int grassGrowSpeedMax = 255;
+
+   // off-screen physics
+   std::vector<int> farLiquidCounters;
+   unsigned long long farPhysicsTick = 0;
+   int farPhysicsRate = 4; // near physics ticks per far tick
+   int farPhysicsCounter = 0;
+   int farPhysicsPhase = 0, farPhysicsRow = 0;
+   int farCellsUpdated = 0, farCellsPending = 0;
+   int farPhysicsCells = 65536; // cells of a far tick updated every fixed update, awake or not
+   bool farPhysicsActive = false;
+   bool farPhysics = true;
+};
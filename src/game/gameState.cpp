@@ -1,10 +1,11 @@
 #include "game/gameState.hpp"
 #include "game/menuState.hpp"
+#include "mngr/assetHandles.hpp"
+#include "mngr/data.hpp"
 #include "mngr/input.hpp"
 #include "mngr/fileio.hpp"
 #include "objs/parallax.hpp"
-#include "SRU/audio.hpp"
-#include "SRU/assets.hpp"
+#include "ui/popup.hpp"
 #include "SRU/particles.hpp"
 #include "SRU/random.hpp"
 #include "SRU/render.hpp"
@@ -13,19 +14,28 @@
 // Constructors
 
 GameState::GameState(const std::string &worldName) {
-   font = getFont("andy");
-   buttonTexture = getTexture("button");
-   vignetteTexture = getTexture("vignette");
-   breakingTexture = getTexture("breaking");
-   bubbleTexture = getTexture("bubble_icon");
-   heartTexture = getTexture("heart_icon");
-   grayscaleShader = getShader("grayscale");
-   waterPreviewShader = getShader("water_preview");
+   font = lookupFont("andy");
+   buttonTexture = lookupTexture("button");
+   vignetteTexture = lookupTexture("vignette");
+   breakingTexture = lookupTexture("breaking");
+   bubbleTexture = lookupTexture("bubble_icon");
+   heartTexture = lookupTexture("heart_icon");
+   grayscaleShader = lookupShader("grayscale");
+   waterPreviewShader = lookupShader("water_preview");
    waterPreviewTimeLocation = GetShaderLocation(waterPreviewShader, "time");
    
    // Init world and camera
    this->worldName = worldName;
-   loadWorldData(worldName, player, camera.zoom, map, console, inventory, droppedItems);
+   // straight back to the menu, without autosaving or saving on the way out so the file is left as it is
+   if (!loadWorldData(worldName, player, camera.zoom, map, console, inventory, droppedItems, &worldLoad, &autosave.bands)) {
+      loadFailed = quitState = true;
+      insertPopup("Failed to Load World", TextFormat("World '%s' could not be loaded, it's either corrupted or from a version that can't be upgraded. The file was left untouched.", worldName.c_str()), PopupType::error);
+      return;
+   }
+   map.initThreadSafe();
+   if (worldLoad.isDone()) {
+      autosave.init(worldName, map); // otherwise once the rest of the world is in
+   }
 
    camera.zoom = std::clamp(camera.zoom, minCameraZoom, maxCameraZoom);
    camera.target = player.getCenter();
@@ -38,22 +48,35 @@ GameState::GameState(const std::string &worldName) {
    menuButton.init(font, buttonTexture, CENTER, "Save & Quit");
    pauseButton.init(font, {0}, CENTER, "Pause");
 
-   liquidCounters.resize(getLiquidCount());
+   physics.init();
    console.init(*this);
    updateResponsiveness();
 }
 
 GameState::~GameState() {
+   if (loadFailed) {
+      return;
+   }
    inventory.discardSelection();
    pushPendingDroppedItems();
 
-   saveWorldData(worldName, player.spawnPos, player.position, player.creative, player.breath, player.hearts, player.maxHearts, camera.zoom, map, &console, &inventory, &droppedItems);
+   // a world that's still loading is saved whole, so it has to be all there first
+   if (!worldLoad.isDone()) {
+      worldLoad.finish(map);
+      autosave.init(worldName, map);
+   }
+   autosave.takeSnapshot(player, camera.zoom, map, console, inventory, droppedItems);
+   autosave.save();
+   autosave.wait();
    resetBackground();
 }
 
 // Update
 
 void GameState::update() {
+   if (loadFailed) {
+      return;
+   }
    if (phase != Phase::died && !console.input.typing) {
       pauseButton.update(dt);
       if (pauseButton.clicked || handleKeyPressWithSound(KEY_ESCAPE)) {
@@ -70,6 +93,20 @@ void GameState::update() {
 }
 
 void GameState::fixedUpdate() {
+   if (loadFailed) {
+      return;
+   }
+   if (!worldLoad.isDone() && worldLoad.publish(map, worldLoadBudget)) {
+      autosave.init(worldName, map);
+   }
+
+   configCheckTimer += fixedUpdateDT;
+   if (configCheckTimer >= configCheckInterval) {
+      configCheckTimer = 0.0f;
+      if (ConfigFile changed = getChangedConfigFiles(); changed != ConfigFile::none) {
+         reloadConfigs(changed);
+      }
+   }
    camera.target = Vector2Lerp(camera.target, player.getCenter(), cameraFollowSpeed);
    if (phase == Phase::paused) {
       calculateCameraBounds(); // Make sure the camera does not go out of bounds
@@ -81,61 +118,23 @@ void GameState::fixedUpdate() {
       phase = Phase::died;
 
       if (lastPhase != phase) {
-         playSound("die");
+         playSound(getAssetHandles().die);
          spawnParticles("dust", 0, nullptr, player.getCenter(), false);
       }
       calculateCameraBounds(); // Make sure the camera does not go out of bounds
-   } else {
-      player.updatePlayer(map);
-   }
-
-   // Update physics
-   physicsCounter = (physicsCounter + 1) % physicsTicks;
-   if (physicsCounter != 0) {
-      return;
-   }
-
-   Rectangle physicsBounds = cameraBounds;
-   Vector2 halfSize = {(cameraBounds.width - cameraBounds.x) / 2.0f, (cameraBounds.height - cameraBounds.y) / 2.0f};
-   physicsBounds.x = std::max<int>(0, cameraBounds.x - halfSize.x);
-   physicsBounds.y = std::max<int>(0, cameraBounds.y - halfSize.y);
-   physicsBounds.width = std::min<int>(map.sizeX - 1, cameraBounds.width + halfSize.x);
-   physicsBounds.height = std::min<int>(map.sizeY - 1, cameraBounds.height + halfSize.y);
-
-   // update liquid counters
-   for (liquidid_t i = 1; i < liquidCounters.size(); ++i) {
-      if (liquidCounters[i] >= getLiquidData(i).updateSpeed) {
-         liquidCounters[i] = 0;
-      }
-      liquidCounters[i] += 1;
+   } else if (map.isAreaLoaded(player.getCenter().x - playerLoadMargin, player.getCenter().y - playerLoadMargin, 2 * playerLoadMargin, 2 * playerLoadMargin)) {
+      player.updatePlayer(map); // held in place until the world around them is in
    }
+   setCurrentBackgroundBiome(map.getBiome(player.getCenter().x).biome);
 
-   // Loop backwards to avoid updating most of the moving blocks twice
-   for (int y = physicsBounds.height; y >= physicsBounds.y; --y) {
-      for (int x = physicsBounds.width; x >= physicsBounds.x; --x) {
-         if (map.isAnyLiquid(x, y)) {
-            liquidid_t id = map.getLiquidId(x, y);
-
-            if (liquidCounters[id] >= getLiquidData(id).updateSpeed) {
-               updateLiquid(x, y, id);
-            }
-         }
-
-         BlockType type = map.getBlock(x, y).type;
-         if (BlockTypeHas(type, BlockType::sand)) {
-            updateSandPhysics(x, y);
-         } else if (BlockTypeHas(type, BlockType::grass)) {
-            updateGrassPhysics(x, y);
-         } else if (BlockTypeHas(type, BlockType::dirt)) {
-            updateDirtPhysics(x, y);
-         } else if (BlockTypeHas(type, BlockType::torch)) {
-            updateTorchPhysics(x, y);
-         }
-      }
-   }
+   physics.fixedUpdate(cameraBounds);
+   autosave.update(fixedUpdateDT, player, camera.zoom, map, console, inventory, droppedItems);
 }
 
 void GameState::updateResponsiveness() {
+   if (loadFailed) {
+      return;
+   }
    camera.offset = getWindowCenter();
    console.updateResponsiveness();
 
@@ -188,7 +187,7 @@ void GameState::updatePlaying() {
    map.updateFurniture(player, mousePos, dt);
 
    // Place and destroy blocks
-   bool actionPossible = map.isPositionValid(mouseX, mouseY) && Vector2Distance(mousePos, playerCenter) <= maxToolRange;
+   bool actionPossible = map.isPositionValid(mouseX, mouseY) && map.isLoaded(mouseX, mouseY) && Vector2Distance(mousePos, playerCenter) <= maxToolRange;
    player.breakingBlock = false;
 
    if (actionPossible && isMousePressedOutsideUI(MOUSE_BUTTON_MIDDLE)) {
@@ -261,7 +260,7 @@ void GameState::updatePlaying() {
       if (player.breakTime >= breakSpeed) {
          if (breakingFurniture) {
             pushDropTable(getFurnitureData(block.id).dropTable);
-            map.furniture[block.ghostId].destroy(map);
+            map.furniture[map.getBlockState(mouseX, mouseY).ghostId].destroy(map);
          }
          else if (breakingWall) {
             pushDropTable(getBlockData(map.getWall(mouseX, mouseY).id).wallDropTable);
@@ -289,7 +288,7 @@ void GameState::updatePlaying() {
       droppedItem.count = (inventory.placeItem(item) ? 0 : item.count);
 
       if (count != droppedItem.count) {
-         playSound("pickup");
+         playSound(getAssetHandles().pickup);
       }
    }
 
@@ -331,174 +330,12 @@ void GameState::updateDying() {
    }
 }
 
-// Block physic update functions
-
-static constexpr unsigned char calculateFlowDown(unsigned char flow1, unsigned char flow2) {
-   unsigned char availableSpace = maxLiquidLayers - flow2;
-   return std::min(availableSpace, flow1);
-}
-
-static void applyFlowDown(unsigned char &flow1, unsigned char &flow2) {
-   unsigned char flowDown = calculateFlowDown(flow1, flow2);
-   flow1 -= flowDown;
-   flow2 += flowDown;
-}
-
-static void applyHalfFlowDown(unsigned char &flow1, unsigned char &flow2) {
-   unsigned char flowDown = calculateFlowDown(flow1, flow2);
-   unsigned char halfFlowDown = (flowDown == 1 ? 1 : flowDown / 2);
-   flow1 -= halfFlowDown;
-   flow2 += halfFlowDown;
-}
-
-bool GameState::handleLiquidToBlock(int x, int y, liquidid_t id) {
-   LiquidData &data = getLiquidData(id);
-   for (const Vector2 &offset: {Vector2{1, 0}, Vector2{0, 1}, Vector2{-1, 0}, Vector2{0, -1}}) {
-      int dx = x + offset.x, dy = y + offset.y;
-      if (!map.isAnyLiquid(dx, dy) || map.isLiquidOfType(dx, dy, id)) {
-         continue;
-      }
-
-      if (map.getLiquidHeight(dx, dy) >= liquidToBlockThreshold && map.getLiquidHeight(x, y) >= liquidToBlockThreshold && map.isNotSolid(dx, dy)) {
-         liquidid_t target = map.getLiquidId(dx, dy);
-         if (data.conversionTable.find(target) != data.conversionTable.end()) {
-            map.setBlock(dx, dy, data.conversionTable[target]);
-         }
-      }
-      map.setLiquid(x, y, 0, 0);
-   }
-   return map.isAnyLiquid(x, y);
-}
-
-void GameState::updateLiquid(int x, int y, liquidid_t id) {
-   if (!handleLiquidToBlock(x, y, id)) {
-      return;
-   }
-   liquidlayer_t height = map.getLiquidHeight(x, y);
-
-   // Delete the liquid if its height is zero
-   if (height == 0) {
-      map.setLiquid(x, y, 0, 0);
-      return;
-   }
-
-   // Handle liquid going down
-   if ((map.getBlock(x, y + 1).tile == TileType::ghost || map.is(x, y + 1, BlockType::flowable)) && !map.isAnyLiquid(x, y + 1)) {
-      std::swap(map.liquidTypes[y * map.sizeX + x], map.liquidTypes[(y + 1) * map.sizeX + x]);
-      std::swap(map.liquidHeights[y * map.sizeX + x], map.liquidHeights[(y + 1) * map.sizeX + x]);
-      return;
-   } else if (map.isAnyLiquid(x, y + 1) && map.isLiquidOfType(x, y + 1, id) && map.getLiquidHeight(x, y + 1) < maxLiquidLayers) {
-      applyFlowDown(map.liquidHeights[y * map.sizeX + x], map.liquidHeights[(y + 1) * map.sizeX + x]);
-   }
-
-   // Handle liquid going left
-   if (((map.getBlock(x - 1, y).tile == TileType::ghost || map.is(x - 1, y, BlockType::flowable)) && !map.isAnyLiquid(x - 1, y))
-    || (map.isAnyLiquid(x - 1, y) && map.isLiquidOfType(x - 1, y, id) && map.getLiquidHeight(x - 1, y) < height && map.getLiquidHeight(x - 1, y) < maxLiquidLayers)) {
-      map.liquidTypes[y * map.sizeX + x - 1] = id;
-      applyHalfFlowDown(map.liquidHeights[y * map.sizeX + x], map.liquidHeights[y * map.sizeX + x - 1]);
-   }
-
-   // Handle liquid going right
-   if (((map.getBlock(x + 1, y).tile == TileType::ghost || map.is(x + 1, y, BlockType::flowable)) && !map.isAnyLiquid(x + 1, y))
-    || (map.isAnyLiquid(x + 1, y) && map.isLiquidOfType(x + 1, y, id) && map.getLiquidHeight(x + 1, y) < height && map.getLiquidHeight(x + 1, y) < maxLiquidLayers)) {
-      map.liquidTypes[y * map.sizeX + x + 1] = id;
-      applyHalfFlowDown(map.liquidHeights[y * map.sizeX + x], map.liquidHeights[y * map.sizeX + x + 1]);
-   }
-}
-
-void GameState::updateSandPhysics(int x, int y) {
-   if (map.isNotSolid(x, y + 1)) {
-      map.swapBlocks(x, y, x, y + 1);
-      return;
-   }
-
-   bool leftEmpty  = map.isNotSolid(x - 1, y + 1);
-   bool rightEmpty = map.isNotSolid(x + 1, y + 1);
-
-   // Hacky solution, but works
-   if (rightEmpty && leftEmpty && chance(50)) {
-      rightEmpty = false;
-   }
-
-   if (rightEmpty) {
-      map.swapBlocks(x, y, x + 1, y + 1);
-   } else if (leftEmpty) {
-      map.swapBlocks(x, y, x - 1, y + 1);
-   }
-}
-
-void GameState::updateGrassPhysics(int x, int y) {
-   if (!map.is(x, y - 1, BlockType::solid)) {
-      return;
-   }
-
-   Block &block = map.blocks[y * map.sizeX + x];
-   if (block.value2 == 0) {
-      block.value2 = randomFloat(grassGrowSpeedMin, grassGrowSpeedMax);
-   }
-
-   block.value += 1;
-   if (block.value >= block.value2) {
-      block.value = 0;
-      block.value2 = 0;
-
-      // This might be a tripping point in the future, when more dirt and
-      // grass is added. I don't care though, I don't want to create a map
-      // here, which'll also be a tripping point. Just define grass exactly
-      // before dirt in objs/map.cpp, please.
-      map.setBlock(x, y, block.id + 1);
-   }
-}
-
-void GameState::updateDirtPhysics(int x, int y) {
-   if (map.is(x, y - 1, BlockType::solid)) {
-      return;
-   }
-
-   Block &block = map.blocks[y * map.sizeX + x];
-   if (block.value2 == 0) {
-      block.value2 = randomFloat(grassGrowSpeedMin, grassGrowSpeedMax);
-   }
-
-   block.value += 1;
-   if (block.value >= block.value2) {
-      block.value = 0;
-      block.value2 = 0;
-   
-      // Same as before. Just define grass exactly before dirt, so IDs
-      // match right
-      map.setBlock(x, y, block.id - 1);
-   }
-}
-
-void GameState::updateTorchPhysics(int x, int y) {
-   Block &block = map.blocks[y * map.sizeX + x];
-   block.value = (block.value + 1) % 5;
-
-   if (map.getLiquidHeight(x, y) > liquidToBlockThreshold) {
-      map.deleteBlockWithoutDeletingLiquids(x, y);
-      return;
-   }
-   bool downEmpty = map.isNotSolid(x, y + 1);
-
-   if (downEmpty && map.isStable(x - 1, y)) {
-      block.value2 = 2;
-   } else if (downEmpty && map.isStable(x + 1, y)) {
-      block.value2 = 3;
-   } else if (downEmpty && !map.isWall(x, y, BlockType::empty)) {
-      block.value2 = 4;
-   } else if (!downEmpty && map.isStable(x, y - 1)) {
-      block.value2 = 1;
-   } else if (!downEmpty) {
-      block.value2 = 0;
-   } else {
-      map.deleteBlock(x, y);
-   }
-}
-
 // Render
 
 void GameState::render() {
+   if (loadFailed) {
+      return;
+   }
    const float delta = (phase != Phase::playing ? 0 : player.delta.x * dt);
    drawBackground(delta, delta, (phase == Phase::paused ? 0.0f : 1.0f) * dt);
 
@@ -651,6 +488,24 @@ void GameState::calculateCameraBounds() {
    cameraBounds.height = std::min(map.sizeY - 1, int(cameraBounds.y + cameraBounds.height) + 1);
 }
 
+// the loading thread reads block data while it decodes, so reloads wait until the world is in. an autosave that is
+// still writing reads the registries too, so it gets to finish first
+bool GameState::reloadConfigs(ConfigFile files) {
+   if (!worldLoad.isDone()) {
+      return false;
+   }
+   autosave.wait();
+   ConfigFile reloaded = reloadData(files);
+
+   if (ConfigFileHas(reloaded, ConfigFile::blocks)) {
+      map.refreshBlockTypes();
+   }
+   if (ConfigFileHas(reloaded, ConfigFile::liquids)) {
+      physics.init(); // sized by the liquid count
+   }
+   return true;
+}
+
 void GameState::pushPendingDroppedItems() {
    Vector2 center = player.getCenter();
    Vector2 dropPosition = {std::clamp<float>(center.x + (player.flipX ? 3 : -3), 0, map.sizeX - 1), center.y};
@@ -1,9 +1,9 @@
 #include "game/loadingState.hpp"
 #include "SRU/util.hpp"
 #include "game/menuState.hpp"
+#include "mngr/assetHandles.hpp"
 #include "mngr/data.hpp"
 #include "ui/popup.hpp"
-#include "SRU/audio.hpp"
 #include "SRU/assets.hpp"
 #include "SRU/file.hpp"
 #include "SRU/text.hpp"
@@ -11,12 +11,13 @@
 
 constexpr float splashFontSize = 40.0f;
 constexpr float loadingTextFontSize = 80.0f;
+constexpr float uploadBudget = 8.0f; // milliseconds of every frame spent handing decoded assets to the GPU
 
 // Constructors
 
 LoadingState::LoadingState() {
    font = loadFont("andy", "assets/fonts/andy.ttf");
-   loadingTexture = loadTexture("loading", "assets/sprites/ui/loading.png");
+   loadingTexture = addTexture("loading", LoadTexture("assets/sprites/ui/loading.png"));
    splashText = getRandomLineFromFile("assets/config/splash.txt");
    wrapInPlace(splashText, font, mapRatioToX(0.9), getFontSizeScaled(splashFontSize));
 }
@@ -24,29 +25,34 @@ LoadingState::LoadingState() {
 void LoadingState::update() {
    iconRotation += dt * 360.0f;
 
-   // Sometimes brute-forcing is better than over-engineering an automatic way to do everything
+   // Sometimes brute-forcing is better than over-engineering an automatic way to do everything. textures and sounds
+   // are decoded on the thread pool while fonts and shaders load, then uploaded a few every frame
    if (loadPhase == Load::fonts) {
+      assetLoader.addFolder("assets/sprites/", DecodedAsset::Kind::texture);
+      assetLoader.addFolder("assets/sounds/", DecodedAsset::Kind::sound);
+      assetLoader.start();
       loadFonts("assets/fonts/");
 
-      loadingText = "Loading Textures... ";
-      loadPhase = Load::textures;
-   } else if (loadPhase == Load::textures) {
-      loadTextures("assets/sprites/");
-      initPopups();
-      initParticles();
-      Image icon = LoadImageFromTexture(getTexture("icon"));
-      SetWindowIcon(icon);
-      UnloadImage(icon);
-
       loadingText = "Loading Shaders... ";
       loadPhase = Load::shaders;
    } else if (loadPhase == Load::shaders) {
       loadShaders("assets/shaders/");
 
-      loadingText = "Loading Sounds... ";
-      loadPhase = Load::sounds;
-   } else if (loadPhase == Load::sounds) {
-      loadSounds("assets/sounds/");
+      loadingText = "Loading Textures and Sounds... ";
+      loadPhase = Load::assets;
+   } else if (loadPhase == Load::assets) {
+      if (!assetLoader.upload(uploadBudget)) {
+         return;
+      }
+      assetLoader.wait();
+      assetLoader.printDecodeTimes();
+      resolveAssetHandles();
+
+      initPopups();
+      initParticles();
+      Image icon = LoadImageFromTexture(lookupTexture("icon"));
+      SetWindowIcon(icon);
+      UnloadImage(icon);
 
       loadingText = "Loading Music... ";
       loadPhase = Load::music;
@@ -55,7 +61,7 @@ void LoadingState::update() {
       loadPhase = Load::data;
    } else if (loadPhase == Load::data) {
       loadData();
-      playSound("success");
+      playSound(getAssetHandles().success);
 
       loadingText = "Loading Done!";
       loadPhase = Load::count;
@@ -1,12 +1,12 @@
 #include "SRU/util.hpp"
 #include "game/gameState.hpp"
 #include "game/menuState.hpp"
+#include "mngr/assetHandles.hpp"
 #include "mngr/input.hpp"
 #include "mngr/fileio.hpp"
 #include "objs/generation.hpp"
 #include "objs/parallax.hpp"
 #include "ui/popup.hpp"
-#include "SRU/assets.hpp"
 #include "SRU/file.hpp"
 #include "SRU/random.hpp"
 #include "SRU/render.hpp"
@@ -18,26 +18,29 @@
 
 constexpr int maxWorldNameSize = 48;
 constexpr int minWorldNameSize = 3;
+constexpr int maxWorldSeedSize = 32;
 
 constexpr float worldSelectionKeyDelay = 0.125f;
 constexpr float worldSelectionKeyStartDelay = 0.333f;
 
+constexpr float generationDoneDelay = 0.5f;
+
 constexpr int defaultMapSizeX = 2000;
 constexpr int defaultMapSizeY = 750;
 
 // Constructors
 
 MenuState::MenuState() {
-   font = getFont("andy");
-   buttonTexture = getTexture("button");
-   searchBarTexture = getTexture("search_bar");
-   barTexture = getTexture("bar");
-   titleTexture = getTexture("title");
-   starTexture = getTexture("star");
-   scrollframeTexture = getTexture("scrollframe");
-   scrollbarTexture = getTexture("scrollbar");
-   longButtonTexture = getTexture("button_long");
-   longSelectedButtonTexture = getTexture("button_long_selected");
+   font = lookupFont("andy");
+   buttonTexture = lookupTexture("button");
+   searchBarTexture = lookupTexture("search_bar");
+   barTexture = lookupTexture("bar");
+   titleTexture = lookupTexture("title");
+   starTexture = lookupTexture("star");
+   scrollframeTexture = lookupTexture("scrollframe");
+   scrollbarTexture = lookupTexture("scrollbar");
+   longButtonTexture = lookupTexture("button_long");
+   longSelectedButtonTexture = lookupTexture("button_long_selected");
 
    // Init title screen
    playButton.init(font, buttonTexture, CENTER, "Play");
@@ -52,6 +55,7 @@ MenuState::MenuState() {
    favoriteButton.init(font, buttonTexture, CENTER, "Favorite", "F");
    playWorldButton.init(font, buttonTexture, CENTER, "Play World");
    newButton.init(font, buttonTexture, CENTER, "New", "N");
+   syncWorldIndex();
    loadWorldButtons();
 
    // Init world creation screen
@@ -59,6 +63,7 @@ MenuState::MenuState() {
    createButtonCreation.init(font, buttonTexture, CENTER, "Create");
    worldName.init(font, buttonTexture, CENTER, maxWorldNameSize, "Name Your New World...");
    shouldWorldBeFlat.init(font, CENTER, "F");
+   worldSeed.init(font, buttonTexture, CENTER, maxWorldSeedSize, "Random Seed...");
 
    // Init world renaming screen
    backButtonRenaming.init(font, buttonTexture, CENTER, "Back");
@@ -117,6 +122,7 @@ void MenuState::updateResponsiveness() {
    createButtonCreation.rect = favoriteButton.rect;
    worldName.rect = mapRatioToArea(R4(0.5f, 0.5f, 0.389f, 0.130f), TOP_LEFT, WINDOW_AREA, CUBIC_RATIO);
    shouldWorldBeFlat.rect = mapRatioToArea(R4(0.5f, 0.6f, 0.064f, 0.064f), TOP_LEFT, WINDOW_AREA, CUBIC_RATIO);
+   worldSeed.rect = mapRatioToArea(R4(0.5f, 0.7f, 0.389f, 0.130f), TOP_LEFT, WINDOW_AREA, CUBIC_RATIO);
 
    // world renaming screen
    backButtonRenaming.rect = backButtonCreation.rect;
@@ -163,6 +169,7 @@ void MenuState::updateLevelSelection() {
       worldSearchBar.typing = false;
       phase = Phase::levelCreation;
       worldName.text = generateRandomWorldName();
+      worldSeed.text.clear();
    }
 
    if (handleKeyPressWithSound(KEY_TAB)) {
@@ -330,10 +337,10 @@ void MenuState::updateLevelSelection() {
    if (wantsToPlay || playWorldButton.clicked || (anySelected && handleKeyPressWithSound(KEY_ENTER))) {
       selectedWorld = selectedButton->text;
 
-      if (getLatestVersion() != getFileVersion(selectedWorld)) {
-         invalidVersionClicked = true;
+      // older worlds are brought up to date on the spot, the ones that can't be aren't opened at all
+      if (getLatestVersion() != getFileVersion(selectedWorld) && !upgradeWorld(selectedWorld)) {
          resetSelection();
-         insertPopup("Confirmation Request", TextFormat("World '%s' uses an outdated file version. The latest version is %d, whereas its version is %d. Are you sure that you want to continue? Your world might get corrupted and become unrecoverable!", selectedWorld.c_str(), getLatestVersion(), getFileVersion(selectedWorld)), PopupType::confirmation);
+         insertPopup("Unsupported Version", TextFormat("World '%s' uses file version %d, which can't be upgraded to the latest version %d. It can't be opened, but the file was left untouched.", selectedWorld.c_str(), getFileVersion(selectedWorld), getLatestVersion()), PopupType::error);
          return;
       }
 
@@ -341,12 +348,6 @@ void MenuState::updateLevelSelection() {
       return;
    }
 
-   if (invalidVersionClicked && isPopupConfirmed()) {
-      fadingOut = playing = true; // User confirmed to corrupt their world
-      return;
-   }
-   invalidVersionClicked = false;
-
    if (anySelected && isMousePressedOutsideUI(MOUSE_BUTTON_LEFT)) {
       resetSelection();
    }
@@ -358,9 +359,11 @@ void MenuState::updateLevelCreation() {
    backButtonCreation.update(dt);
    createButtonCreation.update(dt);
    worldName.update(dt);
+   worldSeed.update(dt);
    shouldWorldBeFlat.update();
+   bool typing = (worldName.typing || worldSeed.typing);
 
-   if (backButtonCreation.clicked || (!worldName.typing && handleKeyPressWithSound(KEY_ESCAPE))) {
+   if (backButtonCreation.clicked || (!typing && handleKeyPressWithSound(KEY_ESCAPE))) {
       phase = Phase::levelSelection;
    }
 
@@ -371,11 +374,11 @@ void MenuState::updateLevelCreation() {
       }
    }
 
-   if (!worldName.typing && handleKeyPressWithSound(KEY_F)) {
+   if (!typing && handleKeyPressWithSound(KEY_F)) {
       shouldWorldBeFlat.checked = !shouldWorldBeFlat.checked;
    }
 
-   if (createButtonCreation.clicked || (!worldName.typing && handleKeyPressWithSound(KEY_ENTER))) {
+   if (createButtonCreation.clicked || (!typing && handleKeyPressWithSound(KEY_ENTER))) {
       // Input characters are capped at maxWorldNameSize already
       if (worldName.text.size() < minWorldNameSize) {
          insertPopup("Invalid World Name", TextFormat("World name must contain from %d to %d characters, but it has %d instead.", minWorldNameSize, maxWorldNameSize, worldName.text.size()), PopupType::error);
@@ -394,6 +397,7 @@ void MenuState::updateLevelCreation() {
       wrapInPlace(generationSplash, font, GetScreenWidth() - mapRatioToX(0.05f, WINDOW_AREA, CUBIC_RATIO), getFontSizeScaled(40.0f));
 
       worldName.typing = false;
+      worldSeed.typing = false;
       phase = Phase::generatingLevel;
    }
 }
@@ -437,7 +441,10 @@ void MenuState::updateLevelRenaming() {
          return;
       }
 
-      std::filesystem::rename(TextFormat("data/worlds/%s.bin", selectedWorld.c_str()), newName);
+      if (!renameWorld(selectedWorld, renameInput.text)) {
+         insertPopup("Notice", TextFormat("World '%s' could not be renamed. Please check the 'data/worlds/' folder, if the file is present, check your permissions.", selectedWorld.c_str()), PopupType::error);
+         return;
+      }
 
       if (wasFavoriteBeforeRenaming) {
          favoriteWorlds.erase(std::remove(favoriteWorlds.begin(), favoriteWorlds.end(), renameInput.text), favoriteWorlds.end());
@@ -459,13 +466,23 @@ void MenuState::updateGeneratingLevel() {
       generatedWorld = false;
       generationProgressBar.progressInterpolation = generationProgressBar.progress = 0.0f;
 
-      generator = new MapGenerator(worldName.text, defaultMapSizeX, defaultMapSizeY, shouldWorldBeFlat.checked, generationInfoTextMutex, generationInfoText, generationProgressBar.progress);
+      generator = new MapGenerator(worldName.text, defaultMapSizeX, defaultMapSizeY, shouldWorldBeFlat.checked, getSeedFromString(worldSeed.text), generationInfoTextMutex, generationInfoText, generationProgressBar.progress);
       std::thread thread(&MapGenerator::generate, generator);
       thread.detach();
    }
    generationProgressBar.update(dt);
 
    if (generator && generator->isCompleted) {
+      // keep the full progress bar on screen for a moment
+      if (generationDoneTimer == 0.0f) {
+         playSound(getAssetHandles().success);
+      }
+      generationDoneTimer += dt;
+
+      if (generationDoneTimer < generationDoneDelay) {
+         return;
+      }
+      generationDoneTimer = 0.0f;
       delete generator;
       loadWorldButtons();
       phase = Phase::levelSelection;
@@ -518,6 +535,20 @@ void MenuState::renderLevelSelection() {
       button.rect = worldFrameButtonRects[i - scrollIndex];
       button.render();
 
+      // the surface of the world along the left of its button
+      const WorldInfo *info = getWorldInfo(button.text);
+      if (info) {
+         float height = button.rect.height * button.scale * 0.5f;
+         float columnWidth = height * 2.0f / worldThumbnailWidth;
+         float left = button.rect.x - (button.rect.width * button.scale) / 2.f + height * 0.5f;
+         float bottom = button.rect.y + height / 2.f;
+
+         for (int x = 0; x < worldThumbnailWidth; ++x) {
+            float columnHeight = height * info->thumbnail[x] / 255.f;
+            drawRect(R4(left + x * columnWidth, bottom - columnHeight, columnWidth, columnHeight), TOP_LEFT, Fade(WHITE, 0.35f));
+         }
+      }
+
       if (button.favorite) {
          Vector2 position = {button.rect.x + (button.rect.width * button.scale) / 2.f - (button.rect.height * button.scale) / 2.f, button.rect.y};
          drawTexture(starTexture, position, mapRatioToArea(0.05f, 0.05f, WINDOW_AREA, CUBIC_RATIO));
@@ -533,10 +564,12 @@ void MenuState::renderLevelCreation() {
    createButtonCreation.render();
    worldName.render();
    shouldWorldBeFlat.render();
+   worldSeed.render();
 
    Vector2 anchor = R4anchor(worldName.rect, worldName.origin, CENTER_LEFT) - mapRatioToArea(0.05f, 0.0f, WINDOW_AREA, CUBIC_RATIO);
    drawText(font, anchor, "World Name:", getFontSizeScaled(50.0f), CENTER_RIGHT);
    drawText(font, V2(anchor.x, shouldWorldBeFlat.rect.y), "Flat World:", getFontSizeScaled(50.0f), CENTER_RIGHT);
+   drawText(font, V2(anchor.x, worldSeed.rect.y), "Seed:", getFontSizeScaled(50.0f), CENTER_RIGHT);
 }
 
 // Render level renaming screen
@@ -575,7 +608,7 @@ State* MenuState::change() {
 
 void MenuState::loadWorldButtons() {
    getLinesFromFileInPlace(favoriteWorlds, "data/favorites.txt");
-   std::filesystem::create_directories("data/worlds/");
+   worldInfos = getWorldIndex();
 
    worldButtons.clear();
    if (anySelected) {
@@ -583,9 +616,9 @@ void MenuState::loadWorldButtons() {
       selectedButton = nullptr;
    }
 
-   for (const auto &file: std::filesystem::directory_iterator("data/worlds")) {
+   for (const WorldInfo &info: worldInfos) {
       Button button;
-      button.init(font, longButtonTexture, CENTER, file.path().stem().string());
+      button.init(font, longButtonTexture, CENTER, info.name);
       button.favorite = isWorldFavorite(button.text);
 
       if (worldSearchBar.text.empty()) {
@@ -636,6 +669,11 @@ std::string MenuState::generateRandomWorldName() const {
    return adjective + " " + noun;
 }
 
+const WorldInfo *MenuState::getWorldInfo(const std::string &name) const {
+   auto info = std::lower_bound(worldInfos.begin(), worldInfos.end(), name, [](const WorldInfo &info, const std::string &name) { return info.name < name; });
+   return (info != worldInfos.end() && info->name == name ? &*info : nullptr);
+}
+
 bool MenuState::isWorldFavorite(const std::string &name) const {
    for (const std::string &world: favoriteWorlds) {
       if (world == name) {
@@ -1,4 +1,5 @@
 #include "game/state.hpp"
+#include "mngr/assetHandles.hpp"
 #include "mngr/input.hpp"
 #include "ui/popup.hpp"
 #include "SRU/particles.hpp"
@@ -61,6 +62,7 @@ void State::renderStateLogic() {
       renderPopups();
       DrawRectangle(0, 0, GetScreenWidth(), GetScreenHeight(), Fade(BLACK, alpha));
    EndDrawing();
+   endAssetLookupFrame();
 }
 
 void State::updateFadingIn() {
@@ -0,0 +1,132 @@
+#include "mngr/assetHandles.hpp"
+#include "SRU/assets.hpp"
+#include "SRU/random.hpp"
+#include <unordered_map>
+
+// Handles
+
+static AssetHandles handles;
+static AssetLookupCounter lookupCounter;
+
+// unordered_map never moves its values, so references into these stay valid as more are added
+static std::unordered_map<std::string, Texture> textures;
+static std::unordered_map<std::string, SoundVariants> sounds;
+
+void resolveAssetHandles() {
+   handles.font.asset = &lookupFont("andy");
+
+   handles.player.asset = &lookupTexture("player");
+   handles.button.asset = &lookupTexture("button");
+   handles.keybind.asset = &lookupTexture("keybind");
+   handles.popupFrame.asset = &lookupTexture("popup_frame");
+   handles.sky.asset = &lookupTexture("sky");
+   handles.stars.asset = &lookupTexture("stars");
+   handles.sun.asset = &lookupTexture("sun");
+   handles.moon.asset = &lookupTexture("moon");
+   handles.lightHuge.asset = &lookupTexture("lightsource_6x");
+   handles.lightLarge.asset = &lookupTexture("lightsource_4x");
+   handles.light.asset = &lookupTexture("lightsource_2x");
+   handles.smallFrame.asset = &lookupTexture("small_frame");
+   handles.smallFrameSelected.asset = &lookupTexture("small_frame_selected");
+   handles.smallFrameFavorite.asset = &lookupTexture("small_frame_favorite");
+   handles.smallFrameFavoriteSelected.asset = &lookupTexture("small_frame_favorite_selected");
+   handles.smallFrameTrash.asset = &lookupTexture("small_frame_trash");
+   handles.water.asset = &lookupShader("water");
+   handles.clip.asset = &lookupShader("clip");
+
+   handles.click.asset = &lookupSound("click");
+   handles.hover.asset = &lookupSound("hover");
+   handles.typing.asset = &lookupSound("typing");
+   handles.success.asset = &lookupSound("success");
+   handles.failure.asset = &lookupSound("failure");
+   handles.notice.asset = &lookupSound("notice");
+   handles.trash.asset = &lookupSound("trash");
+   handles.openInventory.asset = &lookupSound("ui_open_inventory");
+   handles.closeInventory.asset = &lookupSound("ui_close_inventory");
+   handles.jump.asset = &lookupSound("jump");
+   handles.footstep.asset = &lookupSound("footstep");
+   handles.hurt.asset = &lookupSound("hurt");
+   handles.die.asset = &lookupSound("die");
+   handles.pickup.asset = &lookupSound("pickup");
+}
+
+const AssetHandles &getAssetHandles() {
+   return handles;
+}
+
+// Asset functions
+
+Texture &addTexture(const std::string &name, Texture texture) {
+   auto [it, inserted] = textures.try_emplace(name, texture);
+   if (!inserted) {
+      UnloadTexture(it->second);
+      it->second = texture;
+   }
+   return it->second;
+}
+
+SoundVariants &addSound(const std::string &name, Sound sound) {
+   SoundVariants &variants = sounds[name];
+   variants.sounds.push_back(sound);
+   return variants;
+}
+
+// the name a sound file goes under, its stem without the number of the variant
+std::string getSoundName(const std::string &filename) {
+   size_t end = filename.find_last_not_of("0123456789");
+   return (end == std::string::npos ? filename : filename.substr(0, end + 1));
+}
+
+bool hasTexture(const std::string &name) {
+   return textures.count(name) != 0;
+}
+
+bool hasSound(const std::string &name) {
+   return sounds.count(name) != 0;
+}
+
+// Lookup functions
+
+Texture &lookupTexture(const std::string &name) {
+   lookupCounter.frame += 1;
+   auto it = textures.find(name);
+   return (it != textures.end() ? it->second : getTexture(name));
+}
+
+Shader &lookupShader(const std::string &name) {
+   lookupCounter.frame += 1;
+   return getShader(name);
+}
+
+// sounds all come from the asset loader, a missing one plays nothing
+SoundVariants &lookupSound(const std::string &name) {
+   static SoundVariants missing;
+   lookupCounter.frame += 1;
+   auto it = sounds.find(name);
+   return (it != sounds.end() ? it->second : missing);
+}
+
+Font &lookupFont(const std::string &name) {
+   lookupCounter.frame += 1;
+   return getFont(name);
+}
+
+// same as SRU's playSound, minus finding the sound by name
+void playSound(SoundHandle sound, float volume) {
+   if (sound && !sound->sounds.empty()) {
+      Sound &variant = sound->sounds[randomInt(0, sound->sounds.size() - 1)];
+      SetSoundVolume(variant, volume);
+      PlaySound(variant);
+   }
+}
+
+// Lookup counter
+
+AssetLookupCounter &getAssetLookupCounter() {
+   return lookupCounter;
+}
+
+void endAssetLookupFrame() {
+   lookupCounter.lastFrame = lookupCounter.frame;
+   lookupCounter.frame = 0;
+}
@@ -0,0 +1,149 @@
+#include "mngr/assetLoader.hpp"
+#include "mngr/assetHandles.hpp"
+#include "mngr/threadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+
+// Helper functions
+
+static float getMilliseconds(std::chrono::steady_clock::time_point begin) {
+   return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+static bool isDecodable(const std::filesystem::path &path, DecodedAsset::Kind kind) {
+   std::string extension = path.extension().string();
+   if (kind == DecodedAsset::Kind::texture) {
+      return extension == ".png";
+   }
+   return extension == ".wav" || extension == ".ogg" || extension == ".mp3";
+}
+
+// Constructors
+
+AssetLoader::~AssetLoader() {
+   wait();
+   for (DecodedAsset &asset: assets) {
+      if (asset.image.data) UnloadImage(asset.image);
+      if (asset.wave.data) UnloadWave(asset.wave);
+   }
+}
+
+// Decode functions
+
+// assets are named after their file like SRU names them, so lookupTexture and lookupSound find them the same way.
+// names that were already loaded, like the texture of the loading screen, are skipped
+void AssetLoader::addFolder(const std::string &directory, DecodedAsset::Kind kind) {
+   std::error_code error;
+   for (const auto &file: std::filesystem::recursive_directory_iterator(directory, error)) {
+      std::string name = file.path().stem().string();
+      name = (kind == DecodedAsset::Kind::texture ? name : getSoundName(name));
+      bool loaded = (kind == DecodedAsset::Kind::texture ? hasTexture(name) : hasSound(name));
+
+      if (file.is_regular_file() && isDecodable(file.path(), kind) && !loaded) {
+         DecodedAsset &asset = assets.emplace_back();
+         asset.name = name;
+         asset.path = file.path().string();
+         asset.kind = kind;
+      }
+   }
+}
+
+void AssetLoader::start() {
+   thread = std::thread(&AssetLoader::decode, this);
+}
+
+// the biggest files go first so one large image doesn't end up alone on a worker at the end
+void AssetLoader::decode() {
+   auto begin = std::chrono::steady_clock::now();
+   std::vector<std::pair<uintmax_t, int>> order;
+   std::error_code error;
+
+   for (int i = 0; i < (int)assets.size(); ++i) {
+      order.emplace_back(std::filesystem::file_size(assets[i].path, error), i);
+   }
+   std::sort(order.begin(), order.end(), std::greater<>());
+
+   auto decodeAsset = [&](int i) {
+      DecodedAsset &asset = assets[order[i].second];
+      auto assetBegin = std::chrono::steady_clock::now();
+
+      if (asset.kind == DecodedAsset::Kind::texture) {
+         asset.image = LoadImage(asset.path.c_str());
+      } else {
+         asset.wave = LoadWave(asset.path.c_str());
+      }
+      asset.decodeMs = getMilliseconds(assetBegin);
+
+      std::lock_guard<std::mutex> lock (mutex);
+      decoded.push_back(order[i].second);
+   };
+
+   if (parallel) {
+      getThreadPool().run(order.size(), decodeAsset);
+   } else {
+      for (int i = 0; i < (int)order.size(); ++i) {
+         decodeAsset(i);
+      }
+   }
+   decodeMs = getMilliseconds(begin);
+}
+
+void AssetLoader::wait() {
+   if (thread.joinable()) {
+      thread.join();
+   }
+}
+
+// Upload functions
+
+// uploads decoded assets until budget milliseconds are used up, at least one every call. true once all are in
+bool AssetLoader::upload(float budget) {
+   auto begin = std::chrono::steady_clock::now();
+
+   while (uploaded < (int)assets.size()) {
+      int index = 0;
+      {
+         std::lock_guard<std::mutex> lock (mutex);
+         if (decoded.empty()) {
+            break;
+         }
+         index = decoded.front();
+         decoded.pop_front();
+      }
+      DecodedAsset &asset = assets[index];
+
+      if (asset.kind == DecodedAsset::Kind::texture) {
+         addTexture(asset.name, LoadTextureFromImage(asset.image));
+         UnloadImage(asset.image);
+         asset.image = {};
+      } else {
+         addSound(asset.name, LoadSoundFromWave(asset.wave));
+         UnloadWave(asset.wave);
+         asset.wave = {};
+      }
+      uploaded += 1;
+
+      if (getMilliseconds(begin) >= budget) {
+         break;
+      }
+   }
+   return uploaded == (int)assets.size();
+}
+
+void AssetLoader::printDecodeTimes() const {
+   std::vector<const DecodedAsset*> sorted;
+   float totalMs = 0.0f;
+
+   for (const DecodedAsset &asset: assets) {
+      sorted.push_back(&asset);
+      totalMs += asset.decodeMs;
+   }
+   std::sort(sorted.begin(), sorted.end(), [](const DecodedAsset *a, const DecodedAsset *b) { return a->decodeMs > b->decodeMs; });
+
+   printf("Decoded %d assets in %.2fms over %d threads, %.2fms of decoding in total.\n", (int)assets.size(), decodeMs, (parallel ? getThreadPool().getThreadCount() : 1), totalMs);
+   for (const DecodedAsset *asset: sorted) {
+      printf("   %-32s %8.2fms\n", asset->path.c_str(), asset->decodeMs);
+   }
+}
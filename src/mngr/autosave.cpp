@@ -0,0 +1,129 @@
+#include "mngr/autosave.hpp"
+#include "objs/parallax.hpp"
+#include <algorithm>
+#include <chrono>
+
+// Constructors
+
+Autosave::~Autosave() {
+   wait();
+}
+
+void Autosave::init(const std::string &worldName, const Map &map) {
+   wait();
+   this->worldName = worldName;
+   timer = 0.0f; // bands are kept, they come from loading the world and still match its file
+
+   // the first snapshot copies everything, done here so it happens while loading instead of in the middle of a game
+   this->map.sizeX = map.sizeX;
+   this->map.sizeY = map.sizeY;
+   this->map.seed = map.seed;
+   this->map.blocks = map.blocks;
+   this->map.walls = map.walls;
+   this->map.liquidTypes = map.liquidTypes;
+   this->map.liquidHeights = map.liquidHeights;
+   this->map.biomes = map.biomes;
+}
+
+// Update
+
+void Autosave::update(float dt, const Player &player, float zoom, Map &map, const Console &console, const Inventory &inventory, const std::vector<DroppedItem> &droppedItems) {
+   if (interval <= 0.0f || worldName.empty()) {
+      return;
+   }
+   timer += dt;
+
+   // a finished autosave is joined right away so its time shows up
+   if (!saving) {
+      wait();
+   }
+
+   // if the last autosave is somehow still writing, try again next tick instead of touching its snapshot
+   if (timer < interval || saving) {
+      return;
+   }
+   timer = 0.0f;
+
+   takeSnapshot(player, zoom, map, console, inventory, droppedItems);
+   save();
+}
+
+// Snapshot functions
+
+void Autosave::takeSnapshot(const Player &player, float zoom, Map &map, const Console &console, const Inventory &inventory, const std::vector<DroppedItem> &droppedItems) {
+   auto begin = std::chrono::steady_clock::now();
+   wait();
+
+   chunksCopied = 0;
+   for (int chunkY = 0; chunkY < map.chunksY; ++chunkY) {
+      for (int chunkX = 0; chunkX < map.chunksX; ++chunkX) {
+         ChunkFlag flags = map.chunks[chunkY * map.chunksX + chunkX].dirty;
+         if (ChunkFlagHas(flags, ChunkFlag::all)) {
+            copyChunk(map, chunkX, chunkY, flags);
+            map.clearChunkDirty(chunkX, chunkY, ChunkFlag::all);
+            chunksCopied += 1;
+         }
+      }
+   }
+
+   // everything else is small enough to copy whole every time
+   this->map.furniture = map.furniture;
+   this->console.history = console.history;
+   std::copy(std::begin(inventory.items), std::end(inventory.items), std::begin(this->inventory.items));
+   this->droppedItems = droppedItems;
+
+   spawnPosition = player.spawnPos;
+   position = player.position;
+   creative = player.creative;
+   breath = player.breath;
+   hearts = player.hearts;
+   maxHearts = player.maxHearts;
+   this->zoom = zoom;
+   timeOfDay = getTimeOfDay();
+   moonPhase = getMoonPhase();
+
+   snapshotMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void Autosave::copyChunk(const Map &map, int chunkX, int chunkY, ChunkFlag flags) {
+   int minX = chunkX * chunkSize;
+   int width = std::min(chunkSize, map.sizeX - minX);
+   int maxY = std::min(map.sizeY, (chunkY + 1) * chunkSize);
+   bands.markDirty(chunkY * chunkSize, maxY);
+
+   for (int y = chunkY * chunkSize; y < maxY; ++y) {
+      int i = y * map.sizeX + minX;
+      if (ChunkFlagHas(flags, ChunkFlag::blocks)) {
+         std::copy_n(&map.blocks[i], width, &this->map.blocks[i]);
+      }
+
+      if (ChunkFlagHas(flags, ChunkFlag::walls)) {
+         std::copy_n(&map.walls[i], width, &this->map.walls[i]);
+      }
+
+      if (ChunkFlagHas(flags, ChunkFlag::liquids)) {
+         std::copy_n(&map.liquidTypes[i], width, &this->map.liquidTypes[i]);
+         std::copy_n(&map.liquidHeights[i], width, &this->map.liquidHeights[i]);
+      }
+   }
+}
+
+// Save functions
+
+void Autosave::save() {
+   saving = true;
+   thread = std::thread([this]() {
+      auto begin = std::chrono::steady_clock::now();
+      saveWorldData(worldName, spawnPosition, position, creative, breath, hearts, maxHearts, zoom, timeOfDay, moonPhase, map, &console, &inventory, &droppedItems, &bands);
+      threadSaveMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - begin).count();
+      saving = false;
+   });
+}
+
+// saveMs is only written here, after the join, so the console can read it while a save is running
+void Autosave::wait() {
+   if (thread.joinable()) {
+      thread.join();
+      saveMs = threadSaveMs;
+   }
+}
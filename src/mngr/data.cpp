@@ -1,4 +1,5 @@
 #include "mngr/data.hpp"
+#include "mngr/assetHandles.hpp"
 #include "objs/item.hpp"
 #include "objs/map.hpp"
 #include "SRU/assets.hpp"
@@ -6,10 +7,408 @@
 #include "SRU/particles.hpp"
 #include "SRU/text.hpp"
 #include "SRU/util.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_set>
+
+// Constants
+
+constexpr const char *configFilenames[] = {"assets/config/blocks.txt", "assets/config/liquids.txt", "assets/config/furniture.txt", "assets/config/items.txt", "assets/config/drop_tables.txt"};
+constexpr const char *registryCacheFilename = "data/registries.cache";
+constexpr uint32_t registryCacheVersion = 1; // please increment after changing any of the data structs
+
+// What the configs resolved to that the registries don't keep as is, for writing the cache. textures are kept by name
+// since their handles don't survive a restart, and soils since furniture only stores them the other way around
+struct RegistryRecord {
+   std::vector<std::string> blockTextures, liquidTextures, furnitureTextures, itemTextures;
+   std::vector<std::vector<blockid_t>> saplingSoils, treeSoils;
+};
+
+// Reads values one after another out of the cache. reading past its end gives zeroes and marks the reader as failed
+struct CacheReader {
+   void read(void *out, size_t bytes) {
+      if (bytes > data.size() - offset) {
+         std::memset(out, 0, bytes);
+         offset = data.size();
+         failed = true;
+         return;
+      }
+      std::memcpy(out, data.data() + offset, bytes);
+      offset += bytes;
+   }
+
+   template<class T>
+   T read() {
+      T value {};
+      read(&value, sizeof(T));
+      return value;
+   }
+
+   std::string readString() {
+      uint64_t size = read<uint64_t>();
+      if (size > data.size() - offset) {
+         failed = true;
+         return {};
+      }
+      std::string string (data.data() + offset, size);
+      offset += size;
+      return string;
+   }
+
+   std::vector<char> data;
+   size_t offset = 0;
+   bool failed = false;
+};
+
+// headless runs never load textures, so leave every texture empty instead of looking them up
+static bool headlessData = false;
+static RegistryRecord record;
+static size_t firstIds[5] {}; // how many nil entries every registry starts with, the configs add the rest
+static std::filesystem::file_time_type configTimes[5] {};
+
+static Texture getDataTexture(const std::string &name) {
+   return (headlessData ? Texture{0} : lookupTexture(name));
+}
+
+// the texture an entry names, or the one named after the entry if that doesn't exist. an empty name means no texture
+static Texture getRecordTexture(const std::string &name, const std::string &textureName) {
+   if (textureName.empty()) {
+      return Texture{0};
+   }
+   Texture texture = getDataTexture(textureName);
+   return (texture.id == 0 ? getDataTexture(name) : texture);
+}
+
+// filled in by id as the entries are loaded, once every entry has been pushed. growing it keeps what's already there
+static void growRecord() {
+   record.blockTextures.resize(getBlockCount());
+   record.liquidTextures.resize(getLiquidCount());
+   record.furnitureTextures.resize(getFurnitureCount());
+   record.itemTextures.resize(getItemCount());
+   record.saplingSoils.resize(getFurnitureCount());
+   record.treeSoils.resize(getFurnitureCount());
+}
+
+static void initRecord() {
+   record = {};
+   growRecord();
+}
+
+// taken before the files are read, so an edit made while reading them still counts as a change
+static void updateConfigTime(int index) {
+   std::error_code error;
+   configTimes[index] = std::filesystem::last_write_time(configFilenames[index], error);
+}
+
+static float getMilliseconds(std::chrono::steady_clock::time_point begin) {
+   return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// Registry cache helpers
+
+// FNV-1a over every config file, along with the cache version and struct sizes so a build with different structs
+// doesn't read an old cache
+static uint64_t getConfigHash() {
+   uint64_t hash = 1469598103934665603ull;
+   auto mix = [&hash](const char *data, size_t size) {
+      for (size_t i = 0; i < size; ++i) {
+         hash = (hash ^ (unsigned char)data[i]) * 1099511628211ull;
+      }
+   };
+
+   for (const char *filename: configFilenames) {
+      std::ifstream file (filename, std::ios::binary);
+      std::string contents ((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+      uint64_t size = contents.size();
+      mix(reinterpret_cast<const char*>(&size), sizeof(size));
+      mix(contents.data(), contents.size());
+   }
+
+   uint32_t layout[] = {registryCacheVersion, sizeof(BlockData), sizeof(LiquidData), sizeof(FurnitureData), sizeof(ItemData), sizeof(Drop)};
+   mix(reinterpret_cast<const char*>(layout), sizeof(layout));
+   return hash;
+}
+
+static void writeString(std::ofstream &file, const std::string &string) {
+   uint64_t size = string.size();
+   file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+   file.write(string.data(), string.size());
+}
+
+template<class T>
+static void writeValue(std::ofstream &file, const T &value) {
+   file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// Everything the configs added is written in id order, starting after the nil entries the registries start with. data
+// structs are written as they are with their textures cleared
+static void saveRegistryCache(uint64_t configHash) {
+   std::error_code error;
+   std::filesystem::create_directories("data", error);
+
+   std::string tempFilename = std::string(registryCacheFilename) + ".tmp";
+   std::ofstream file (tempFilename, std::ios::binary);
+   writeValue(file, configHash);
+
+   size_t counts[] = {getBlockCount(), getLiquidCount(), getFurnitureCount(), getItemCount(), getDropTableCount()};
+   for (int i = 0; i < 5; ++i) {
+      writeValue<uint64_t>(file, counts[i] - firstIds[i]);
+   }
+
+   for (blockid_t id = firstIds[0]; id < (blockid_t)counts[0]; ++id) {
+      BlockData data = getBlockData(id);
+      data.texture = Texture{0};
+      writeString(file, getBlockNameFromId(id));
+      writeString(file, record.blockTextures[id]);
+      writeValue(file, data);
+   }
+
+   for (liquidid_t id = firstIds[1]; id < (liquidid_t)counts[1]; ++id) {
+      const LiquidData &data = getLiquidData(id);
+      writeString(file, getLiquidNameFromId(id));
+      writeString(file, record.liquidTextures[id]);
+      writeValue(file, data.updateSpeed);
+      writeValue(file, data.moveSpeedMultiplier);
+      writeValue(file, data.naturalLight);
+      writeValue(file, data.glow);
+      writeValue(file, data.damagePlayer);
+      writeValue(file, data.damageMin);
+      writeValue(file, data.damageMax);
+
+      writeValue<uint64_t>(file, data.conversionTable.size());
+      for (auto &[liquid, block]: data.conversionTable) {
+         writeValue(file, liquid);
+         writeValue(file, block);
+      }
+   }
+
+   for (furnitureid_t id = firstIds[2]; id < (furnitureid_t)counts[2]; ++id) {
+      FurnitureData data = getFurnitureData(id);
+      data.texture = Texture{0};
+      writeString(file, getFurnitureNameFromId(id));
+      writeString(file, record.furnitureTextures[id]);
+      writeValue(file, data);
+
+      for (const std::vector<blockid_t> *soils: {&record.saplingSoils[id], &record.treeSoils[id]}) {
+         writeValue<uint64_t>(file, soils->size());
+         file.write(reinterpret_cast<const char*>(soils->data()), soils->size() * sizeof(blockid_t));
+      }
+   }
+
+   for (itemid_t id = firstIds[3]; id < (itemid_t)counts[3]; ++id) {
+      ItemData data = getItemData(id);
+      data.texture = Texture{0};
+      writeString(file, getItemNameFromId(id));
+      writeString(file, record.itemTextures[id]);
+      writeValue(file, data);
+   }
+
+   for (droptableid_t id = firstIds[4]; id < (droptableid_t)counts[4]; ++id) {
+      const DropTable &table = getDropTable(id);
+      writeString(file, getDropTableNameFromId(id));
+      writeValue<uint64_t>(file, table.drops.size());
+      file.write(reinterpret_cast<const char*>(table.drops.data()), table.drops.size() * sizeof(Drop));
+   }
+
+   file.close();
+   if (file.fail()) {
+      std::filesystem::remove(tempFilename, error);
+      printf("saveRegistryCache: Failed to write '%s'.\n", registryCacheFilename);
+      return;
+   }
+   std::filesystem::rename(tempFilename, registryCacheFilename, error);
+}
+
+// Only fills the registries once the whole cache read fine, so a broken one can still fall back to the configs
+static bool loadRegistryCache(uint64_t configHash) {
+   std::ifstream file (registryCacheFilename, std::ios::binary);
+   if (!file.is_open()) {
+      return false;
+   }
+
+   CacheReader cache;
+   cache.data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+   if (cache.read<uint64_t>() != configHash || cache.failed) {
+      return false;
+   }
+
+   uint64_t counts[5];
+   for (uint64_t &count: counts) {
+      count = cache.read<uint64_t>();
+      if (count > cache.data.size()) {
+         return false;
+      }
+   }
+   RegistryRecord cached;
+   std::vector<std::string> blockNames, liquidNames, furnitureNames, itemNames, dropTableNames;
+   std::vector<BlockData> blocks;
+   std::vector<LiquidData> liquids;
+   std::vector<FurnitureData> furniture;
+   std::vector<ItemData> items;
+   std::vector<DropTable> dropTables;
+
+   for (uint64_t i = 0; i < counts[0] && !cache.failed; ++i) {
+      blockNames.push_back(cache.readString());
+      cached.blockTextures.push_back(cache.readString());
+      blocks.push_back(cache.read<BlockData>());
+   }
+
+   for (uint64_t i = 0; i < counts[1] && !cache.failed; ++i) {
+      LiquidData &data = liquids.emplace_back();
+      liquidNames.push_back(cache.readString());
+      cached.liquidTextures.push_back(cache.readString());
+      data.updateSpeed = cache.read<int>();
+      data.moveSpeedMultiplier = cache.read<float>();
+      data.naturalLight = cache.read<bool>();
+      data.glow = cache.read<bool>();
+      data.damagePlayer = cache.read<bool>();
+      data.damageMin = cache.read<int>();
+      data.damageMax = cache.read<int>();
+
+      uint64_t conversions = cache.read<uint64_t>();
+      for (uint64_t j = 0; j < conversions && !cache.failed; ++j) {
+         liquidid_t liquid = cache.read<liquidid_t>();
+         data.conversionTable[liquid] = cache.read<blockid_t>();
+      }
+   }
+
+   for (uint64_t i = 0; i < counts[2] && !cache.failed; ++i) {
+      furnitureNames.push_back(cache.readString());
+      cached.furnitureTextures.push_back(cache.readString());
+      furniture.push_back(cache.read<FurnitureData>());
+
+      for (auto *soils: {&cached.saplingSoils.emplace_back(), &cached.treeSoils.emplace_back()}) {
+         uint64_t count = cache.read<uint64_t>();
+         for (uint64_t j = 0; j < count && !cache.failed; ++j) {
+            soils->push_back(cache.read<blockid_t>());
+         }
+      }
+   }
+
+   for (uint64_t i = 0; i < counts[3] && !cache.failed; ++i) {
+      itemNames.push_back(cache.readString());
+      cached.itemTextures.push_back(cache.readString());
+      items.push_back(cache.read<ItemData>());
+   }
+
+   for (uint64_t i = 0; i < counts[4] && !cache.failed; ++i) {
+      DropTable &table = dropTables.emplace_back();
+      dropTableNames.push_back(cache.readString());
+
+      uint64_t drops = cache.read<uint64_t>();
+      for (uint64_t j = 0; j < drops && !cache.failed; ++j) {
+         Drop &drop = table.drops.emplace_back(0, 0.0f, 0, 0);
+         cache.read(&drop, sizeof(Drop));
+      }
+   }
+
+   if (cache.failed || cache.offset != cache.data.size()) {
+      printf("loadRegistryCache: '%s' is corrupted, reading the config files instead.\n", registryCacheFilename);
+      return false;
+   }
+
+   // same order as the configs, so every id comes out the same
+   reserveBlockContainers(blockNames.size());
+   reserveLiquidContainers(liquidNames.size());
+   reserveFurnitureContainers(furnitureNames.size());
+   reserveItemContainers(itemNames.size());
+   reserveDropTableContainers(dropTableNames.size());
+
+   for (const std::string &name: blockNames) pushBlock(name);
+   for (const std::string &name: liquidNames) pushLiquid(name);
+   for (const std::string &name: furnitureNames) pushFurniture(name);
+   for (const std::string &name: itemNames) pushItem(name);
+   for (const std::string &name: dropTableNames) pushDropTable(name);
+
+   initRecord();
+
+   for (size_t i = 0; i < blocks.size(); ++i) {
+      blocks[i].texture = getRecordTexture(blockNames[i], cached.blockTextures[i]);
+      record.blockTextures[getBlockIdFromName(blockNames[i])] = cached.blockTextures[i];
+      setBlock(blockNames[i], blocks[i]);
+   }
+
+   for (size_t i = 0; i < liquids.size(); ++i) {
+      liquids[i].texture = getRecordTexture(liquidNames[i], cached.liquidTextures[i]);
+      record.liquidTextures[getLiquidIdFromName(liquidNames[i])] = cached.liquidTextures[i];
+      setLiquid(liquidNames[i], liquids[i]);
+   }
+
+   for (size_t i = 0; i < furniture.size(); ++i) {
+      furnitureid_t id = getFurnitureIdFromName(furnitureNames[i]);
+      furniture[i].texture = getRecordTexture(furnitureNames[i], cached.furnitureTextures[i]);
+      record.furnitureTextures[id] = cached.furnitureTextures[i];
+      record.saplingSoils[id] = cached.saplingSoils[i];
+      record.treeSoils[id] = cached.treeSoils[i];
+      setFurniture(furnitureNames[i], furniture[i], cached.saplingSoils[i], cached.treeSoils[i]);
+   }
+
+   for (size_t i = 0; i < items.size(); ++i) {
+      items[i].texture = getRecordTexture(itemNames[i], cached.itemTextures[i]);
+      record.itemTextures[getItemIdFromName(itemNames[i])] = cached.itemTextures[i];
+      setItem(itemNames[i], items[i]);
+   }
+
+   for (size_t i = 0; i < dropTables.size(); ++i) {
+      setDropTable(dropTableNames[i], dropTables[i]);
+   }
+   return true;
+}
+
+// Reload helpers
+
+// ids are saved in worlds and held by everything that's loaded, so entries a config gained go at the end and every
+// id already handed out stays the same
+template<class IsNameValid, class Push>
+static void pushNewEntries(const std::vector<Header> &headers, IsNameValid isNameValid, Push push) {
+   for (const Header &header: headers) {
+      if (!isNameValid(header.name)) {
+         push(header.name);
+      }
+   }
+}
+
+// entries taken out of a config keep their id and their old data until the next restart
+template<class GetName>
+static std::unordered_set<std::string> warnRemovedEntries(const std::vector<Header> &headers, size_t firstId, size_t count, GetName getName, const char *filename) {
+   std::unordered_set<std::string> names, removed;
+   for (const Header &header: headers) {
+      names.insert(header.name);
+   }
+
+   for (size_t id = firstId; id < count; ++id) {
+      std::string name = getName(id);
+      if (names.find(name) == names.end()) {
+         printf("reloadData: '%s' was removed from '%s', it stays loaded until the game restarts.\n", name.c_str(), filename);
+         removed.insert(name);
+      }
+   }
+   return removed;
+}
 
 // data functions
 
-void loadData() {
+void loadData(bool headless) {
+   headlessData = headless;
+
+   // the configs are only parsed when they changed since the cache was written
+   auto cacheBegin = std::chrono::steady_clock::now();
+   size_t counts[] = {getBlockCount(), getLiquidCount(), getFurnitureCount(), getItemCount(), getDropTableCount()};
+   std::copy(std::begin(counts), std::end(counts), firstIds);
+   for (int i = 0; i < 5; ++i) {
+      updateConfigTime(i);
+   }
+   uint64_t configHash = getConfigHash();
+   if (loadRegistryCache(configHash)) {
+      printf("Restored all registries from '%s'. Took %.2fms.\n", registryCacheFilename, getMilliseconds(cacheBegin));
+      return;
+   }
+   float cacheMs = getMilliseconds(cacheBegin);
+
+   auto parseBegin = std::chrono::steady_clock::now();
    printf("Reading all config files...\n");
    std::vector<Header> blockHeaders = getHeadersFromConfig("assets/config/blocks.txt", "#", "[", "]", '=');
    std::vector<Header> liquidHeaders = getHeadersFromConfig("assets/config/liquids.txt", "#", "[", "]", '=');
@@ -37,7 +436,97 @@ void loadData() {
    loadItemData(itemHeaders);
    printf("Loading drop table data from 'assets/config/drop_tables.txt'...\n");
    loadDropTableData(dropHeaders);
-   printf("Loading done!\n");
+   float parseMs = getMilliseconds(parseBegin);
+
+   auto saveBegin = std::chrono::steady_clock::now();
+   saveRegistryCache(configHash);
+   printf("Loading done! Parsing took %.2fms, checking the cache %.2fms and rewriting it %.2fms.\n", parseMs, cacheMs, getMilliseconds(saveBegin));
+}
+
+// compares every config file against the time it had when it was last read
+ConfigFile getChangedConfigFiles() {
+   ConfigFile changed = ConfigFile::none;
+   std::error_code error;
+
+   for (int i = 0; i < 5; ++i) {
+      auto time = std::filesystem::last_write_time(configFilenames[i], error);
+      if (!error && time != configTimes[i]) {
+         changed = changed | static_cast<ConfigFile>(1 << i);
+      }
+   }
+   return changed;
+}
+
+// Parses the given config files again and updates their entries in place. only those files are read, references into
+// the others resolve through ids that don't change. returns the files that were actually reloaded
+ConfigFile reloadData(ConfigFile files) {
+   auto begin = std::chrono::steady_clock::now();
+   std::vector<Header> headers[5];
+   ConfigFile reloaded = ConfigFile::none;
+
+   for (int i = 0; i < 5; ++i) {
+      ConfigFile file = static_cast<ConfigFile>(1 << i);
+      if (!ConfigFileHas(files, file)) {
+         continue;
+      }
+
+      if (!std::filesystem::exists(configFilenames[i])) {
+         printf("reloadData: '%s' does not exist, keeping what was loaded from it.\n", configFilenames[i]);
+         continue;
+      }
+      printf("Reloading '%s'...\n", configFilenames[i]);
+      updateConfigTime(i);
+      headers[i] = getHeadersFromConfig(configFilenames[i], "#", "[", "]", '=');
+      reloaded = reloaded | file;
+   }
+
+   if (reloaded == ConfigFile::none) {
+      return reloaded;
+   }
+
+   // every new name has to exist before any file is loaded, same as the pre-pass
+   pushNewEntries(headers[0], isBlockNameValid, pushBlock);
+   pushNewEntries(headers[1], isLiquidNameValid, pushLiquid);
+   pushNewEntries(headers[2], isFurnitureNameValid, pushFurniture);
+   pushNewEntries(headers[3], isItemNameValid, pushItem);
+   pushNewEntries(headers[4], isDropTableNameValid, pushDropTable);
+   growRecord();
+
+   if (ConfigFileHas(reloaded, ConfigFile::blocks)) {
+      warnRemovedEntries(headers[0], firstIds[0], getBlockCount(), getBlockNameFromId, configFilenames[0]);
+      loadBlockData(headers[0]);
+   }
+
+   if (ConfigFileHas(reloaded, ConfigFile::liquids)) {
+      warnRemovedEntries(headers[1], firstIds[1], getLiquidCount(), getLiquidNameFromId, configFilenames[1]);
+      loadLiquidData(headers[1]);
+   }
+
+   // setFurniture adds to the soil lookups, so they're built again from scratch
+   if (ConfigFileHas(reloaded, ConfigFile::furniture)) {
+      std::unordered_set<std::string> removed = warnRemovedEntries(headers[2], firstIds[2], getFurnitureCount(), getFurnitureNameFromId, configFilenames[2]);
+      clearFurnitureSoils();
+      loadFurnitureData(headers[2]);
+
+      for (const std::string &name: removed) {
+         furnitureid_t id = getFurnitureIdFromName(name);
+         setFurniture(name, getFurnitureData(id), record.saplingSoils[id], record.treeSoils[id]);
+      }
+   }
+
+   if (ConfigFileHas(reloaded, ConfigFile::items)) {
+      warnRemovedEntries(headers[3], firstIds[3], getItemCount(), getItemNameFromId, configFilenames[3]);
+      loadItemData(headers[3]);
+   }
+
+   if (ConfigFileHas(reloaded, ConfigFile::dropTables)) {
+      warnRemovedEntries(headers[4], firstIds[4], getDropTableCount(), getDropTableNameFromId, configFilenames[4]);
+      loadDropTableData(headers[4]);
+   }
+
+   saveRegistryCache(getConfigHash());
+   printf("Reloading done! Took %.2fms.\n", getMilliseconds(begin));
+   return reloaded;
 }
 
 void loadPrepass(std::vector<Header> &blockHeaders, std::vector<Header> &liquidHeaders, std::vector<Header> &furnitureHeaders, std::vector<Header> &itemHeaders, std::vector<Header> &dropHeaders) {
@@ -60,22 +549,18 @@ void loadPrepass(std::vector<Header> &blockHeaders, std::vector<Header> &liquidH
    for (Header &header: dropHeaders) {
       pushDropTable(header.name);
    }
+
+   initRecord();
 }
 
 void loadBlockData(std::vector<Header> &headers) {
    for (Header &header: headers) {
       BlockData data;
-      bool noTexture = false;
+      std::string textureName = header.name;
 
       for (auto &[field, value]: header.lines) {
          if (field == "texture") {
-            if (value.empty()) {
-               data.texture.id = 0;
-               noTexture = true;
-            }
-            else {
-               data.texture = getTexture(value);
-            }
+            textureName = value;
          }
          else if (field == "drop_table") {
             if (!isDropTableNameValid(value)) {
@@ -123,6 +608,13 @@ void loadBlockData(std::vector<Header> &headers) {
             }
             data.wallToolType = getToolTypeFromString(value);
          }
+         else if (field == "turns_into") {
+            if (!isBlockNameValid(value)) {
+               printf("loadBlockData: Block '%s' does not exist.\n", value.c_str());
+               continue;
+            }
+            data.turnsInto = getBlockIdFromName(value);
+         }
          else if (field == "attributes") {
             std::vector<std::string> attributes = getArrayValue(value);
             for (std::string &attribute: attributes) {
@@ -138,9 +630,8 @@ void loadBlockData(std::vector<Header> &headers) {
          }
       }
 
-      if (!noTexture && data.texture.id == 0) {
-         data.texture = getTexture(header.name);
-      }
+      data.texture = getRecordTexture(header.name, textureName);
+      record.blockTextures[getBlockIdFromName(header.name)] = textureName;
       setBlock(header.name, data);
    }
 }
@@ -148,17 +639,11 @@ void loadBlockData(std::vector<Header> &headers) {
 void loadLiquidData(std::vector<Header> &headers) {
    for (Header &header: headers) {
       LiquidData data;
-      bool noTexture = false;
+      std::string textureName = header.name;
 
       for (auto &[field, value]: header.lines) {
          if (field == "texture") {
-            if (value.empty()) {
-               data.texture.id = 0;
-               noTexture = true;
-            }
-            else {
-               data.texture = getTexture(value);
-            }
+            textureName = value;
          }
          else if (field == "update_speed") {
             data.updateSpeed = getIntValue(value);
@@ -201,9 +686,8 @@ void loadLiquidData(std::vector<Header> &headers) {
          }
       }
 
-      if (!noTexture && data.texture.id == 0) {
-         data.texture = getTexture(header.name);
-      }
+      data.texture = getRecordTexture(header.name, textureName);
+      record.liquidTextures[getLiquidIdFromName(header.name)] = textureName;
       setLiquid(header.name, data);
    }
 }
@@ -211,18 +695,12 @@ void loadLiquidData(std::vector<Header> &headers) {
 void loadFurnitureData(std::vector<Header> &headers) {
    for (Header &header: headers) {
       FurnitureData data;
-      bool noTexture = false;
+      std::string textureName = header.name;
       std::vector<blockid_t> saplingSoils, treeSoils;
 
       for (auto &[field, value]: header.lines) {
          if (field == "texture") {
-            if (value.empty()) {
-               data.texture.id = 0;
-               noTexture = true;
-            }
-            else {
-               data.texture = getTexture(value);
-            }
+            textureName = value;
          }
          else if (field == "type") {
             if (!isFurnitureTypeValid(value)) {
@@ -319,9 +797,11 @@ void loadFurnitureData(std::vector<Header> &headers) {
          }
       }
 
-      if (!noTexture && data.texture.id == 0) {
-         data.texture = getTexture(header.name);
-      }
+      data.texture = getRecordTexture(header.name, textureName);
+      furnitureid_t id = getFurnitureIdFromName(header.name);
+      record.furnitureTextures[id] = textureName;
+      record.saplingSoils[id] = saplingSoils;
+      record.treeSoils[id] = treeSoils;
       setFurniture(header.name, data, saplingSoils, treeSoils);
    }
 }
@@ -329,17 +809,11 @@ void loadFurnitureData(std::vector<Header> &headers) {
 void loadItemData(std::vector<Header> &headers) {
    for (Header &header: headers) {
       ItemData data;
-      bool noTexture = false;
+      std::string textureName = header.name;
 
       for (auto &[field, value]: header.lines) {
          if (field == "texture") {
-            if (value.empty()) {
-               data.texture.id = 0;
-               noTexture = true;
-            }
-            else {
-               data.texture = getTexture(value);
-            }
+            textureName = value;
          }
          else if (field == "block") {
             if (!isBlockNameValid(value)) {
@@ -384,9 +858,8 @@ void loadItemData(std::vector<Header> &headers) {
          }
       }
 
-      if (!noTexture && data.texture.id == 0) {
-         data.texture = getTexture(header.name);
-      }
+      data.texture = getRecordTexture(header.name, textureName);
+      record.itemTextures[getItemIdFromName(header.name)] = textureName;
       setItem(header.name, data);
    }
 }
@@ -426,5 +899,5 @@ void loadDropTableData(std::vector<Header> &headers) {
 }
 
 void initParticles() {
-   pushParticleCluster("dust", ParticleConfig{&getTexture("dust"), {V2(), V2(-1.3f), V2(), V2(0.5f), 0.99f, 0.0f, -720.0f, 0.0f, 0.5f}, {V2(), V2(1.3f), V2(), V2(0.9f), 1.01f, 360.0f, 720.0f, 0.0f, 1.3f}, 8});
+   pushParticleCluster("dust", ParticleConfig{&lookupTexture("dust"), {V2(), V2(-1.3f), V2(), V2(0.5f), 0.99f, 0.0f, -720.0f, 0.0f, 0.5f}, {V2(), V2(1.3f), V2(), V2(0.9f), 1.01f, 360.0f, 720.0f, 0.0f, 1.3f}, 8});
 }
@@ -1,181 +1,416 @@
 #include "mngr/fileio.hpp"
+#include "mngr/mappedFile.hpp"
+#include "mngr/threadPool.hpp"
 #include "objs/console.hpp"
 #include "objs/inventory.hpp"
 #include "objs/map.hpp"
 #include "objs/parallax.hpp"
 #include "objs/player.hpp"
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <limits>
+#include <memory>
+#include <numeric>
 #include <vector>
 
 // Please increment after any breaking changes to warn players about corrupted worlds
-constexpr int fileVersion = 13;
+constexpr int fileVersion = 19;
 
-// Save and load functions must follow the same data arrangement. save here takes in optional arguments since world generator
-// does not have them
-void saveWorldData(const std::string &name, const Vector2 &playerSpawnPosition, const Vector2 &position, bool creative, int breath, int hearts, int maxHearts, float zoom, const Map &map, const Console *console, const Inventory *inventory, const std::vector<DroppedItem> *droppedItems) {
-   auto begin = std::chrono::steady_clock::now();
-   std::string filename = "data/worlds/" + name + ".bin";
-   std::ofstream file (filename, std::ios::binary);
+// Oldest version upgradeWorld still knows the layout of
+constexpr int oldestUpgradableVersion = 13;
 
-   if (!file.is_open()) {
-      printf("saveWorldData: Failed to save world '%s'.\n", filename.c_str());
-      return;
-   }
+// Worlds are saved in bands of this many rows
+constexpr int worldBandRows = 32;
 
-   // Write basic data. we check for inventory here since freshly generated maps don't pass it. and there's no reason
-   // to save the time and moon phase of the main menu.
-   float timeOfDay = (inventory ? getTimeOfDay() : 0);
-   int moonPhase = (inventory ? getMoonPhase() : 0);
+// Since version 19 a world starts with its version and where its directory is, the bands and the directory can be
+// anywhere after that
+constexpr uint64_t worldHeadSize = sizeof(int) + sizeof(uint64_t);
 
-   file.write(reinterpret_cast<const char*>(&fileVersion), sizeof(fileVersion));
-   file.write(reinterpret_cast<const char*>(&playerSpawnPosition.x), sizeof(playerSpawnPosition.x));
-   file.write(reinterpret_cast<const char*>(&playerSpawnPosition.y), sizeof(playerSpawnPosition.y));
-   file.write(reinterpret_cast<const char*>(&position.x), sizeof(position.x));
-   file.write(reinterpret_cast<const char*>(&position.y), sizeof(position.y));
-   file.write(reinterpret_cast<const char*>(&creative), sizeof(creative));
-   file.write(reinterpret_cast<const char*>(&breath), sizeof(breath));
-   file.write(reinterpret_cast<const char*>(&hearts), sizeof(hearts));
-   file.write(reinterpret_cast<const char*>(&maxHearts), sizeof(maxHearts));
-   file.write(reinterpret_cast<const char*>(&map.sizeX), sizeof(map.sizeX));
-   file.write(reinterpret_cast<const char*>(&map.sizeY), sizeof(map.sizeY));
-   file.write(reinterpret_cast<const char*>(&zoom), sizeof(zoom));
-   file.write(reinterpret_cast<const char*>(&timeOfDay), sizeof(timeOfDay));
-   file.write(reinterpret_cast<const char*>(&moonPhase), sizeof(moonPhase));
-
-   // Write inventory
-   if (inventory) {
-      file.write(reinterpret_cast<const char*>(inventory->items), realInventorySlots * sizeof(Item));
-   } else {
-      Item item [realInventorySlots];
-      file.write(reinterpret_cast<const char*>(item), realInventorySlots * sizeof(Item));
-   }
-
-   // Write console history
-   size_t consoleHistorySize = (console ? console->history.size() : 0);
-   file.write(reinterpret_cast<const char*>(&consoleHistorySize), sizeof(consoleHistorySize));
-   if (console) {
-      for (const std::string &string : console->history) {
-         size_t size = string.size();
-         file.write(reinterpret_cast<const char*>(&size), sizeof(size));
-         file.write(reinterpret_cast<const char*>(string.data()), string.size());
-      }
-   }
-
-   // Write the map
-   int mapBlockCount = map.sizeX * map.sizeY;
-   std::vector<blockid_t> blocks, walls;
-   blocks.reserve(mapBlockCount);
-   walls.reserve(mapBlockCount);
-
-   // my dead ass simple compression algorithm that groups blocks together and writes the count and the ID. we then have
-   // a super nice map.fill function to nicely fill these chunks after reading. since blockid_t is unsigned short and can
-   // only hold a value up to 65k, we need to check against max. went from 9MB to ~250KB for a fresh world. a flat world
-   // at creation is now under 1KB in size
-   blockid_t lastBlock = (map.blocks.empty() ? 0 : map.blocks.front().id);
-   blockid_t blockCount = 0;
-   blockid_t blockMax = std::numeric_limits<blockid_t>::max();
-   
-   for (const Block &tile: map.blocks) {
-      // basically set ID to 0 for ghost tiles (furniture). or get a corrupted world
-      blockid_t id = (tile.tile == TileType::root) * tile.id;
+// Share of a world file that saves appending changed bands can leave dead before one compacts it
+constexpr double worldDeadSpaceLimit = 0.5;
+
+// The world index, in its own file so it isn't listed as a world
+constexpr const char *worldIndexFilename = "data/worlds.idx";
+constexpr int worldIndexVersion = 1;
+
+// Bands a progressive load decodes before returning, the ones nearest to the player. enough to cover the screen at
+// the lowest zoom
+constexpr int progressiveLoadBands = 7;
+
+// Liquids are saved as one value per tile, the type above the height
+constexpr int liquidHeightBits = 6;
+constexpr uint32_t liquidHeightMask = (1 << liquidHeightBits) - 1;
 
-      if (id == lastBlock && blockCount != blockMax) {
-         blockCount += 1;
+// Palette index for block IDs not in the palette yet
+constexpr uint32_t noPaletteIndex = std::numeric_limits<uint32_t>::max();
+
+// Header functions
+
+// The fields at the start of every world file. they're the same in every version, except for the seed
+struct WorldHeader {
+   int version = 0;
+   Vector2 spawnPosition {}, position {};
+   bool creative = false;
+   int breath = 0, hearts = 0, maxHearts = 0;
+   int sizeX = 0, sizeY = 0;
+   float zoom = 0.0f, timeOfDay = 0.0f;
+   int moonPhase = 0;
+   uint64_t seed = 0;
+};
+
+// Reads values one after another out of a mapped world file. reading past its end gives zeroes and marks the reader
+// as failed, so a cut off file can't make the loader read outside of the mapping
+struct WorldReader {
+   void read(char *out, size_t bytes) {
+      if (bytes > size - offset) {
+         std::memset(out, 0, bytes);
+         offset = size;
+         failed = true;
+         return;
       }
-      else {
-         blocks.push_back(blockCount);
-         blocks.push_back(lastBlock);
-         lastBlock = id;
-         blockCount = 1;
+      std::memcpy(out, data + offset, bytes);
+      offset += bytes;
+   }
+
+   // hands out the bytes where they are in the mapping instead of copying them
+   const char *take(size_t bytes) {
+      if (bytes > size - offset) {
+         offset = size;
+         failed = true;
+         return nullptr;
       }
+      const char *result = data + offset;
+      offset += bytes;
+      return result;
    }
-   blocks.push_back(blockCount);
-   blocks.push_back(lastBlock);
 
-   // do the same for walls...
-   blockid_t lastWall = (map.walls.empty() ? 0 : map.walls.front().id);
-   blockid_t wallCount = 0;
-   blockid_t wallMax = std::numeric_limits<blockid_t>::max();
+   const char *data = nullptr;
+   size_t size = 0;
+   size_t offset = 0;
+   bool failed = false;
+};
 
-   for (const Wall &tile: map.walls) {
-      if (tile.id == lastWall && wallCount != wallMax) {
-         wallCount += 1;
-      }
-      else {
-         walls.push_back(wallCount);
-         walls.push_back(lastWall);
-         lastWall = tile.id;
-         wallCount = 1;
-      }
+static void readHeader(WorldReader &file, WorldHeader &header) {
+   file.read(reinterpret_cast<char*>(&header.version), sizeof(header.version));
+   file.read(reinterpret_cast<char*>(&header.spawnPosition.x), sizeof(header.spawnPosition.x));
+   file.read(reinterpret_cast<char*>(&header.spawnPosition.y), sizeof(header.spawnPosition.y));
+   file.read(reinterpret_cast<char*>(&header.position.x), sizeof(header.position.x));
+   file.read(reinterpret_cast<char*>(&header.position.y), sizeof(header.position.y));
+   file.read(reinterpret_cast<char*>(&header.creative), sizeof(header.creative));
+   file.read(reinterpret_cast<char*>(&header.breath), sizeof(header.breath));
+   file.read(reinterpret_cast<char*>(&header.hearts), sizeof(header.hearts));
+   file.read(reinterpret_cast<char*>(&header.maxHearts), sizeof(header.maxHearts));
+   file.read(reinterpret_cast<char*>(&header.sizeX), sizeof(header.sizeX));
+   file.read(reinterpret_cast<char*>(&header.sizeY), sizeof(header.sizeY));
+   file.read(reinterpret_cast<char*>(&header.zoom), sizeof(header.zoom));
+   file.read(reinterpret_cast<char*>(&header.timeOfDay), sizeof(header.timeOfDay));
+   file.read(reinterpret_cast<char*>(&header.moonPhase), sizeof(header.moonPhase));
+
+   // version 14 added the seed, older worlds simply don't know theirs
+   header.seed = 0;
+   if (header.version >= 14) {
+      file.read(reinterpret_cast<char*>(&header.seed), sizeof(header.seed));
    }
-   walls.push_back(wallCount);
-   walls.push_back(lastWall);
+}
 
-   // write size too since we have no idea how many chunks we'll get
-   size_t blockSize = blocks.size();
-   size_t wallSize = walls.size();
-   file.write(reinterpret_cast<const char*>(&blockSize), sizeof(blockSize));
-   file.write(reinterpret_cast<const char*>(&wallSize), sizeof(wallSize));
-   file.write(reinterpret_cast<const char*>(blocks.data()), blocks.size() * sizeof(blockid_t));
-   file.write(reinterpret_cast<const char*>(walls.data()), walls.size() * sizeof(blockid_t));
+static void writeHeader(std::ostream &file, const WorldHeader &header) {
+   file.write(reinterpret_cast<const char*>(&header.version), sizeof(header.version));
+   file.write(reinterpret_cast<const char*>(&header.spawnPosition.x), sizeof(header.spawnPosition.x));
+   file.write(reinterpret_cast<const char*>(&header.spawnPosition.y), sizeof(header.spawnPosition.y));
+   file.write(reinterpret_cast<const char*>(&header.position.x), sizeof(header.position.x));
+   file.write(reinterpret_cast<const char*>(&header.position.y), sizeof(header.position.y));
+   file.write(reinterpret_cast<const char*>(&header.creative), sizeof(header.creative));
+   file.write(reinterpret_cast<const char*>(&header.breath), sizeof(header.breath));
+   file.write(reinterpret_cast<const char*>(&header.hearts), sizeof(header.hearts));
+   file.write(reinterpret_cast<const char*>(&header.maxHearts), sizeof(header.maxHearts));
+   file.write(reinterpret_cast<const char*>(&header.sizeX), sizeof(header.sizeX));
+   file.write(reinterpret_cast<const char*>(&header.sizeY), sizeof(header.sizeY));
+   file.write(reinterpret_cast<const char*>(&header.zoom), sizeof(header.zoom));
+   file.write(reinterpret_cast<const char*>(&header.timeOfDay), sizeof(header.timeOfDay));
+   file.write(reinterpret_cast<const char*>(&header.moonPhase), sizeof(header.moonPhase));
+   file.write(reinterpret_cast<const char*>(&header.seed), sizeof(header.seed));
+}
 
-   // liquids are relatively scarce in the world, so 255 liquids per chunk is miniscule. we can optimize this just by saving
-   // them as integers. flat maps will just save a single chunk of liquids, since they don't have any.
-   std::vector<int> liquidHeights, liquidTypes;
-   liquidHeights.reserve(mapBlockCount / 1000); // absurd to allocate all 1,5 million spots
-   liquidTypes.reserve(mapBlockCount / 1000);
+// counts and sizes are 64 bit since version 17. before that they were whatever size_t was on the machine that saved
+static uint64_t readCount(WorldReader &file, int version) {
+   if (version < 17) {
+      size_t count = 0;
+      file.read(reinterpret_cast<char*>(&count), sizeof(count));
+      return count;
+   }
 
-   // unlike we did for walls and blocks, we won't check for max here as 2 billion blocks is kind of a huge number. 2000x750
-   // maps for comparison only have 1,5 million blocks. and they're pretty big.
-   int lastLiquid = (map.liquidTypes.empty() ? 0 : map.liquidTypes.front());
-   int liquidCount = 0;
+   uint64_t count = 0;
+   file.read(reinterpret_cast<char*>(&count), sizeof(count));
+   return count;
+}
 
-   for (liquidid_t id: map.liquidTypes) {
-      if (id == lastLiquid) {
-         liquidCount += 1;
+static void writeCount(std::ostream &file, uint64_t count) {
+   file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+}
+
+static void readStrings(WorldReader &file, int version, std::vector<std::string> &strings) {
+   uint64_t count = readCount(file, version);
+   strings.clear();
+
+   for (uint64_t i = 0; i < count && !file.failed; ++i) {
+      uint64_t size = readCount(file, version);
+      const char *string = file.take(size);
+      strings.push_back(string ? std::string(string, size) : std::string());
+   }
+}
+
+static void writeStrings(std::ostream &file, const std::vector<std::string> &strings) {
+   writeCount(file, strings.size());
+   for (const std::string &string: strings) {
+      writeCount(file, string.size());
+      file.write(string.data(), string.size());
+   }
+}
+
+// Map encoding functions
+
+// Run lengths and values are written as varints, 7 bits a byte with the top bit set on every byte but the last. most
+// runs and palette indices fit in one or two bytes
+static void writeVarint(std::vector<char> &out, uint32_t value) {
+   while (value >= 0x80) {
+      out.push_back(char((value & 0x7f) | 0x80));
+      value >>= 7;
+   }
+   out.push_back(char(value));
+}
+
+// false if the data ends in the middle of one
+static bool readVarint(const char *&data, const char *end, uint32_t &value) {
+   value = 0;
+   for (int shift = 0; shift < 32 && data != end; shift += 7) {
+      unsigned char byte = *data++;
+      value |= uint32_t(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+         return true;
       }
-      else {
-         liquidTypes.push_back(liquidCount);
-         liquidTypes.push_back(lastLiquid);
-         lastLiquid = id;
-         liquidCount = 1;
+   }
+   return false;
+}
+
+static uint32_t packLiquid(int type, int height) {
+   return (uint32_t(type) << liquidHeightBits) | std::min<uint32_t>(std::max(height, 0), liquidHeightMask);
+}
+
+// my dead ass simple compression algorithm that groups tiles together and writes the count and the ID, now both as
+// varints. pushing the same value again just makes the current run longer, so tiles and whole runs of an old file can
+// be pushed the same way
+struct RunWriter {
+   void push(uint32_t value, uint32_t length = 1) {
+      if (length == 0) {
+         return;
+      }
+
+      if (count != 0 && value == last) {
+         count += length;
+         return;
+      }
+      flush();
+      last = value;
+      count = length;
+   }
+
+   void flush() {
+      if (count != 0) {
+         writeVarint(out, count);
+         writeVarint(out, last);
+         count = 0;
       }
    }
-   liquidTypes.push_back(liquidCount);
-   liquidTypes.push_back(lastLiquid);
 
-   // do the same for liquid height...
-   int lastLiquidHeight = (map.liquidHeights.empty() ? 0 : map.liquidHeights.front());
-   int liquidHeightCount = 0;
+   std::vector<char> &out;
+   uint32_t last = 0;
+   uint32_t count = 0;
+};
 
-   for (liquidlayer_t h: map.liquidHeights) {
-      if (h == lastLiquidHeight) {
-         liquidHeightCount += 1;
+// a band is the size of its block and wall runs, then the block, wall and liquid runs. blocks and walls are indices
+// into the palette of the file
+static void appendBand(std::vector<char> &out, const std::vector<char> &blocks, const std::vector<char> &walls, const std::vector<char> &liquids) {
+   writeVarint(out, blocks.size());
+   writeVarint(out, walls.size());
+   out.insert(out.end(), blocks.begin(), blocks.end());
+   out.insert(out.end(), walls.begin(), walls.end());
+   out.insert(out.end(), liquids.begin(), liquids.end());
+}
+
+// rows minY to maxY - 1, with paletteIndex going from block IDs to their place in the palette
+static void encodeBand(const Map &map, int minY, int maxY, const std::vector<uint32_t> &paletteIndex, std::vector<char> &out) {
+   std::vector<char> blocks, walls, liquids;
+   RunWriter blockRuns {blocks}, wallRuns {walls}, liquidRuns {liquids};
+
+   for (int i = minY * map.sizeX; i < maxY * map.sizeX; ++i) {
+      // basically set ID to 0 for ghost tiles (furniture). or get a corrupted world
+      blockRuns.push(paletteIndex[(map.blocks[i].tile == TileType::root) * map.blocks[i].id]);
+      wallRuns.push(paletteIndex[map.walls[i].id]);
+      liquidRuns.push(packLiquid(map.liquidTypes[i], map.liquidHeights[i]));
+   }
+   blockRuns.flush();
+   wallRuns.flush();
+   liquidRuns.flush();
+   appendBand(out, blocks, walls, liquids);
+}
+
+// adds the IDs used in rows minY to maxY - 1 that aren't in the palette yet to missing, once each
+static void findMissingIds(const Map &map, int minY, int maxY, const std::vector<uint32_t> &paletteIndex, std::vector<blockid_t> &missing) {
+   std::vector<bool> seen (paletteIndex.size(), false);
+   auto check = [&](blockid_t id) {
+      if (paletteIndex[id] == noPaletteIndex && !seen[id]) {
+         seen[id] = true;
+         missing.push_back(id);
       }
-      else {
-         liquidHeights.push_back(liquidHeightCount);
-         liquidHeights.push_back(lastLiquidHeight);
-         lastLiquidHeight = h;
-         liquidHeightCount = 1;
+   };
+
+   for (int i = minY * map.sizeX; i < maxY * map.sizeX; ++i) {
+      check((map.blocks[i].tile == TileType::root) * map.blocks[i].id);
+      check(map.walls[i].id);
+   }
+}
+
+// every block ID goes to its index in the palette, or noPaletteIndex
+static std::vector<uint32_t> getPaletteIndex(const std::vector<blockid_t> &palette) {
+   std::vector<uint32_t> paletteIndex (size_t(std::numeric_limits<blockid_t>::max()) + 1, noPaletteIndex);
+   for (size_t i = 0; i < palette.size(); ++i) {
+      paletteIndex[palette[i]] = i;
+   }
+   return paletteIndex;
+}
+
+// Map decoding functions
+
+// The block, wall and liquid runs of a band, pointing into the mapped file. they cover tiles begin to end - 1
+struct BandRuns {
+   const char *runs[3] {};
+   const char *runsEnd[3] {};
+   int begin = 0;
+   int end = 0;
+};
+
+enum class WorldSection { blocks, walls, liquids, furniture, count };
+constexpr int tileSectionCount = 3;
+constexpr const char *worldSectionNames[] = {"blocks", "walls", "liquids", "furniture"};
+
+// finds the run lists of a band appendBand wrote
+static bool findBandRuns(const char *data, const char *end, BandRuns &runs) {
+   uint32_t blocksSize = 0, wallsSize = 0;
+   if (!readVarint(data, end, blocksSize) || !readVarint(data, end, wallsSize) || size_t(end - data) < size_t(blocksSize) + wallsSize) {
+      return false;
+   }
+
+   runs.runs[0] = data;
+   runs.runsEnd[0] = runs.runs[1] = data + blocksSize;
+   runs.runsEnd[1] = runs.runs[2] = runs.runs[1] + wallsSize;
+   runs.runsEnd[2] = end;
+   return true;
+}
+
+// expands runs of (count, value) straight from the mapped file into a lane, from tile i up to end. runs that go past
+// the end are cut off, so a damaged file can't write outside of the map
+template<class Function>
+static void decodeRuns(const char *data, const char *dataEnd, int i, int end, Function fill) {
+   uint32_t count = 0, value = 0;
+   while (i < end && readVarint(data, dataEnd, count) && readVarint(data, dataEnd, value)) {
+      int n = (int)std::min<long long>(count, end - i);
+      fill(i, n, value);
+      i += n;
+   }
+}
+
+// Where decoded tiles go, either the lanes of the map or a band decoded away from it
+struct TileLanes {
+   Block *blocks = nullptr;
+   Wall *walls = nullptr;
+   liquidid_t *liquidTypes = nullptr;
+   liquidlayer_t *liquidHeights = nullptr;
+};
+
+static TileLanes getTileLanes(Map &map) {
+   return {map.blocks.data(), map.walls.data(), map.liquidTypes.data(), map.liquidHeights.data()};
+}
+
+static TileLanes getTileLanes(DecodedBand &band) {
+   return {band.blocks.data(), band.walls.data(), band.liquidTypes.data(), band.liquidHeights.data()};
+}
+
+// one section of a band. the bands and sections all write to different tiles or lanes, so they can run at the same
+// time. planes, surfaces and furniture are left for after
+static void decodeBandSection(const TileLanes &lanes, const BandRuns &band, const std::vector<blockid_t> &palette, WorldSection section) {
+   // palette indices the file doesn't have become air instead of reading past the palette
+   auto getId = [&](uint32_t index) {
+      return (index < palette.size() ? palette[index] : blockid_t(0));
+   };
+
+   switch (section) {
+   case WorldSection::blocks:
+      decodeRuns(band.runs[0], band.runsEnd[0], band.begin, band.end, [&](int i, int n, uint32_t index) {
+         blockid_t id = getId(index);
+         std::fill_n(lanes.blocks + i, n, Block{id, getBlockData(id).attributes, TileType::root});
+      });
+      break;
+   case WorldSection::walls:
+      decodeRuns(band.runs[1], band.runsEnd[1], band.begin, band.end, [&](int i, int n, uint32_t index) {
+         blockid_t id = getId(index);
+         std::fill_n(lanes.walls + i, n, Wall{id, getBlockData(id).attributes});
+      });
+      break;
+   case WorldSection::liquids:
+      decodeRuns(band.runs[2], band.runsEnd[2], band.begin, band.end, [&](int i, int n, uint32_t liquid) {
+         std::fill_n(lanes.liquidTypes + i, n, liquidid_t(liquid >> liquidHeightBits));
+         std::fill_n(lanes.liquidHeights + i, n, liquidlayer_t(liquid & liquidHeightMask));
+      });
+      break;
+   default: break;
+   }
+}
+
+// Furniture functions
+
+// the furniture and dropped items at the end of the file, furniture is placed on the map later
+static void readFurniture(WorldReader file, int version, std::vector<Furniture> &furniture, std::vector<DroppedItem> &droppedItems) {
+   uint64_t furnitureCount = readCount(file, version);
+
+   for (uint64_t i = 0; i < furnitureCount && !file.failed; ++i) {
+      Furniture obj;
+      file.read(reinterpret_cast<char*>(&obj.id), sizeof(obj.id));
+      file.read(reinterpret_cast<char*>(&obj.x), sizeof(obj.x));
+      file.read(reinterpret_cast<char*>(&obj.y), sizeof(obj.y));
+      file.read(reinterpret_cast<char*>(&obj.width), sizeof(obj.width));
+      file.read(reinterpret_cast<char*>(&obj.height), sizeof(obj.height));
+      file.read(reinterpret_cast<char*>(&obj.flipped), sizeof(obj.flipped));
+      file.read(reinterpret_cast<char*>(&obj.ivalue1), sizeof(obj.ivalue1));
+      file.read(reinterpret_cast<char*>(&obj.ivalue2), sizeof(obj.ivalue2));
+      file.read(reinterpret_cast<char*>(&obj.fvalue1), sizeof(obj.fvalue1));
+      file.read(reinterpret_cast<char*>(&obj.fvalue2), sizeof(obj.fvalue2));
+
+      if (obj.width <= 0 || obj.height <= 0 || size_t(obj.width) * obj.height > file.size - file.offset) {
+         file.failed = true;
+         break;
       }
+      obj.pieces.resize(obj.width * obj.height);
+      file.read(reinterpret_cast<char*>(obj.pieces.data()), obj.pieces.size() * sizeof(FurniturePiece));
+      furniture.push_back(std::move(obj));
    }
-   liquidHeights.push_back(liquidHeightCount);
-   liquidHeights.push_back(lastLiquidHeight);
 
-   // and again write the size with the data.
-   size_t liquidTypeSize = liquidTypes.size();
-   size_t liquidHeightSize = liquidHeights.size();
-   file.write(reinterpret_cast<const char*>(&liquidTypeSize), sizeof(liquidTypeSize));
-   file.write(reinterpret_cast<const char*>(&liquidHeightSize), sizeof(liquidHeightSize));
-   file.write(reinterpret_cast<const char*>(liquidTypes.data()), liquidTypes.size() * sizeof(int));
-   file.write(reinterpret_cast<const char*>(liquidHeights.data()), liquidHeights.size() * sizeof(int));
+   // and read dropped items
+   uint64_t droppedItemCount = readCount(file, version);
+   droppedItems.resize(file.failed || droppedItemCount > file.size / sizeof(DroppedItem) ? 0 : droppedItemCount);
 
-   // Write the furniture
-   size_t furnitureCount = map.furniture.size();
-   file.write(reinterpret_cast<const char*>(&furnitureCount), sizeof(furnitureCount));
+   if (!droppedItems.empty()) {
+      file.read(reinterpret_cast<char*>(droppedItems.data()), droppedItems.size() * sizeof(DroppedItem));
+   }
+}
+
+static void writeFurniture(std::ostream &file, const std::vector<Furniture> &furniture, const std::vector<DroppedItem> *droppedItems) {
+   writeCount(file, std::count_if(furniture.begin(), furniture.end(), [](const Furniture &obj) { return obj.id != 0; }));
 
-   for (const Furniture &obj: map.furniture) {
+   for (const Furniture &obj: furniture) {
       if (obj.id == 0) continue; // we don't want any deleted furniture here.
       file.write(reinterpret_cast<const char*>(&obj.id), sizeof(obj.id));
       file.write(reinterpret_cast<const char*>(&obj.x), sizeof(obj.x));
@@ -191,166 +426,987 @@ void saveWorldData(const std::string &name, const Vector2 &playerSpawnPosition,
    }
 
    // Write dropped items
-   size_t droppedItemCount = (droppedItems ? droppedItems->size() : 0);
-   file.write(reinterpret_cast<const char*>(&droppedItemCount), sizeof(droppedItemCount));
+   writeCount(file, (droppedItems ? droppedItems->size() : 0));
    if (droppedItems) {
       file.write(reinterpret_cast<const char*>(droppedItems->data()), droppedItems->size() * sizeof(DroppedItem));
    }
+}
 
-   // everything's done
-   auto end = std::chrono::steady_clock::now();
+// World file functions
+
+// Everything in a world but its bands: the header, inventory, console history, palette, where every band is in the
+// file, the biomes and the furniture. the palette has the names of the blocks instead of their IDs, which are only
+// their place in blocks.txt and change whenever a block is added or moved there
+static void writeDirectory(std::ostream &file, const WorldHeader &header, const char *inventory, const std::vector<std::string> &history, const std::vector<blockid_t> &palette, const std::vector<uint64_t> &bandOffsets, const std::vector<std::vector<char>> &bands, const std::vector<BiomeColumn> &biomes, const std::vector<Furniture> &furniture, const std::vector<DroppedItem> *droppedItems) {
+   writeHeader(file, header);
+   file.write(inventory, realInventorySlots * sizeof(Item));
+   writeStrings(file, history);
+
+   std::vector<std::string> paletteNames;
+   for (blockid_t id: palette) {
+      paletteNames.push_back(getBlockNameFromId(isBlockIdValid(id) ? id : 0));
+   }
+   writeStrings(file, paletteNames);
+
+   int bandCount = bands.size();
+   std::vector<uint64_t> bandSizes;
+   for (const std::vector<char> &band: bands) {
+      bandSizes.push_back(band.size());
+   }
+   file.write(reinterpret_cast<const char*>(&worldBandRows), sizeof(worldBandRows));
+   file.write(reinterpret_cast<const char*>(&bandCount), sizeof(bandCount));
+   file.write(reinterpret_cast<const char*>(bandOffsets.data()), bandCount * sizeof(uint64_t));
+   file.write(reinterpret_cast<const char*>(bandSizes.data()), bandCount * sizeof(uint64_t));
+
+   file.write(reinterpret_cast<const char*>(biomes.data()), biomes.size() * sizeof(BiomeColumn));
+   writeFurniture(file, furniture, droppedItems);
+}
+
+// the file points at its directory last, so until then it still points at the one it had
+static void writeDirectoryOffset(std::ostream &file, uint64_t directoryOffset) {
+   file.flush();
+   file.seekp(sizeof(int));
+   file.write(reinterpret_cast<const char*>(&directoryOffset), sizeof(directoryOffset));
+   file.flush();
+}
+
+// a whole world file, the head, every band one after another and the directory. bandOffsets is filled in with where
+// the bands went and the start of the directory is returned
+static uint64_t writeWorldFile(std::ostream &file, const WorldHeader &header, const char *inventory, const std::vector<std::string> &history, const std::vector<blockid_t> &palette, const std::vector<std::vector<char>> &bands, std::vector<uint64_t> &bandOffsets, const std::vector<BiomeColumn> &biomes, const std::vector<Furniture> &furniture, const std::vector<DroppedItem> *droppedItems) {
+   uint64_t offset = 0;
+   file.write(reinterpret_cast<const char*>(&fileVersion), sizeof(fileVersion));
+   file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+
+   offset = worldHeadSize;
+   bandOffsets.assign(bands.size(), 0);
+   for (size_t band = 0; band < bands.size(); ++band) {
+      bandOffsets[band] = offset;
+      file.write(bands[band].data(), bands[band].size());
+      offset += bands[band].size();
+   }
+
+   writeDirectory(file, header, inventory, history, palette, bandOffsets, bands, biomes, furniture, droppedItems);
+   writeDirectoryOffset(file, offset);
+   return offset;
+}
+
+// Temporary file functions
+
+// the world goes to a temporary file first and replaces the old one once it's complete, so a crash in the middle of
+// saving leaves the last save intact
+static bool replaceWithTemporary(std::ofstream &file, const std::string &tempFilename, const std::string &filename) {
    file.close();
-   size_t writeSize = std::filesystem::file_size(filename);
-   printf("Successfully wrote %lluB (%lluKB) to '%s'. Took %lldms.\n", writeSize, writeSize / 1000, filename.c_str(), std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count());
+   std::error_code error;
+   if (!file.fail()) {
+      std::filesystem::rename(tempFilename, filename, error);
+   }
+
+   if (file.fail() || error) {
+      std::filesystem::remove(tempFilename, error);
+      return false;
+   }
+   return true;
+}
+
+static float getMilliseconds(std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end) {
+   return std::chrono::duration<float, std::milli>(end - begin).count();
+}
+
+// World index helpers. saves come from the autosave and generator threads too, so everything goes through the mutex
+
+static std::mutex worldIndexMutex;
+static std::vector<WorldInfo> worldIndex; // sorted by name
+static bool worldIndexLoaded = false;
+
+static void loadWorldIndex() {
+   if (worldIndexLoaded) {
+      return;
+   }
+   worldIndexLoaded = true;
+
+   std::ifstream in (worldIndexFilename, std::ios::binary);
+   std::vector<char> buffer ((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+   WorldReader file {buffer.data(), buffer.size()};
+
+   int version = 0;
+   std::vector<std::string> names;
+   file.read(reinterpret_cast<char*>(&version), sizeof(version));
+   if (version != worldIndexVersion) {
+      return; // missing or from another version, syncWorldIndex fills it back in
+   }
+   readStrings(file, fileVersion, names);
+
+   std::vector<WorldInfo> infos (names.size());
+   for (size_t i = 0; i < infos.size() && !file.failed; ++i) {
+      infos[i].name = names[i];
+      file.read(reinterpret_cast<char*>(&infos[i].version), sizeof(infos[i].version));
+      file.read(reinterpret_cast<char*>(&infos[i].sizeX), sizeof(infos[i].sizeX));
+      file.read(reinterpret_cast<char*>(&infos[i].sizeY), sizeof(infos[i].sizeY));
+      file.read(reinterpret_cast<char*>(&infos[i].lastPlayed), sizeof(infos[i].lastPlayed));
+      file.read(reinterpret_cast<char*>(&infos[i].fileSize), sizeof(infos[i].fileSize));
+      file.read(reinterpret_cast<char*>(infos[i].thumbnail.data()), infos[i].thumbnail.size());
+   }
+
+   if (!file.failed) {
+      worldIndex = std::move(infos);
+   }
+}
+
+static void saveWorldIndex() {
+   std::string tempFilename = std::string(worldIndexFilename) + ".tmp";
+   std::ofstream file (tempFilename, std::ios::binary);
+
+   std::vector<std::string> names;
+   for (const WorldInfo &info: worldIndex) {
+      names.push_back(info.name);
+   }
+   file.write(reinterpret_cast<const char*>(&worldIndexVersion), sizeof(worldIndexVersion));
+   writeStrings(file, names);
+
+   for (const WorldInfo &info: worldIndex) {
+      file.write(reinterpret_cast<const char*>(&info.version), sizeof(info.version));
+      file.write(reinterpret_cast<const char*>(&info.sizeX), sizeof(info.sizeX));
+      file.write(reinterpret_cast<const char*>(&info.sizeY), sizeof(info.sizeY));
+      file.write(reinterpret_cast<const char*>(&info.lastPlayed), sizeof(info.lastPlayed));
+      file.write(reinterpret_cast<const char*>(&info.fileSize), sizeof(info.fileSize));
+      file.write(reinterpret_cast<const char*>(info.thumbnail.data()), info.thumbnail.size());
+   }
+
+   if (!replaceWithTemporary(file, tempFilename, worldIndexFilename)) {
+      printf("saveWorldIndex: Failed to save the world index '%s'.\n", worldIndexFilename);
+   }
+}
+
+static std::vector<WorldInfo>::iterator findWorldInfo(const std::string &name) {
+   auto info = std::lower_bound(worldIndex.begin(), worldIndex.end(), name, [](const WorldInfo &info, const std::string &name) { return info.name < name; });
+   return (info != worldIndex.end() && info->name == name ? info : worldIndex.end());
+}
+
+static void setWorldInfo(const WorldInfo &info) {
+   auto it = findWorldInfo(info.name);
+   if (it != worldIndex.end()) {
+      *it = info;
+   } else {
+      worldIndex.insert(std::lower_bound(worldIndex.begin(), worldIndex.end(), info.name, [](const WorldInfo &info, const std::string &name) { return info.name < name; }), info);
+   }
 }
 
-void loadWorldData(const std::string &name, Player &player, float &zoom, Map &map, Console &console, Inventory &inventory, std::vector<DroppedItem> &droppedItems) {
+// for worlds the index doesn't know, only their header is read. the thumbnail stays empty until the next save, and
+// a world too short to have a header keeps version 0 so the menu warns about it
+static void readWorldInfo(const std::string &name, WorldInfo &info) {
+   std::string filename = "data/worlds/" + name + ".bin";
+   std::ifstream in (filename, std::ios::binary);
+   char buffer[128];
+
+   // since version 19 the header is in the directory, wherever the head says that is
+   int version = 0;
+   uint64_t directoryOffset = 0;
+   in.read(reinterpret_cast<char*>(&version), sizeof(version));
+   in.read(reinterpret_cast<char*>(&directoryOffset), sizeof(directoryOffset));
+   in.clear();
+   in.seekg(version >= 19 ? directoryOffset : 0);
+   in.read(buffer, sizeof(buffer));
+
+   WorldReader file {buffer, size_t(in.gcount())};
+   WorldHeader header;
+   readHeader(file, header);
+
+   std::error_code error;
+   auto writeTime = std::filesystem::last_write_time(filename, error);
+   auto writtenAt = std::chrono::system_clock::now() + std::chrono::duration_cast<std::chrono::system_clock::duration>(writeTime - std::filesystem::file_time_type::clock::now());
+
+   info.name = name;
+   info.version = (file.failed ? 0 : header.version);
+   info.sizeX = header.sizeX;
+   info.sizeY = header.sizeY;
+   info.lastPlayed = std::chrono::duration_cast<std::chrono::seconds>(writtenAt.time_since_epoch()).count();
+   info.fileSize = std::filesystem::file_size(filename, error);
+}
+
+// the surface in worldThumbnailWidth evenly spaced columns
+static void getThumbnail(const Map &map, WorldInfo &info) {
+   if (map.sizeX <= 0 || map.sizeY <= 0) {
+      return;
+   }
+
+   for (int i = 0; i < worldThumbnailWidth; ++i) {
+      int x = std::min<long long>(map.sizeX - 1, ((long long)i * 2 + 1) * map.sizeX / (worldThumbnailWidth * 2));
+      int y = 0;
+
+      // furniture keeps its ID in the blocks it covers, so its ghost tiles count as air like they're saved
+      while (y < map.sizeY && (map.blocks[y * map.sizeX + x].id == 0 || map.blocks[y * map.sizeX + x].tile == TileType::ghost)) {
+         y += 1;
+      }
+      info.thumbnail[i] = 255 - y * 255 / map.sizeY;
+   }
+}
+
+// Save and load functions must follow the same data arrangement. save here takes in optional arguments since world generator
+// does not have them
+void saveWorldData(const std::string &name, const Vector2 &playerSpawnPosition, const Vector2 &position, bool creative, int breath, int hearts, int maxHearts, float zoom, float timeOfDay, int moonPhase, const Map &map, const Console *console, const Inventory *inventory, const std::vector<DroppedItem> *droppedItems, WorldBands *cache) {
    auto begin = std::chrono::steady_clock::now();
    std::string filename = "data/worlds/" + name + ".bin";
-   std::ifstream file (filename, std::ios::binary);
+   std::string tempFilename = filename + ".tmp";
 
-   if (!file.is_open()) {
+   // Encode the map. every band of rows is encoded on its own worker. with a cache only the bands that changed are
+   // encoded again, and the palette only ever grows so the indices in the cached bands stay valid
+   int bandCount = (map.sizeY + worldBandRows - 1) / worldBandRows;
+   WorldBands uncached;
+   WorldBands &bands = (cache ? *cache : uncached);
+
+   if ((int)bands.bands.size() != bandCount) {
+      bands.bands.assign(bandCount, {});
+      bands.dirty.assign(bandCount, true);
+      bands.palette.clear();
+      bands.offsets.clear();
+   }
+
+   if (bands.palette.empty()) {
+      bands.palette.push_back(0); // air first, so empty parts of the map are runs of zeroes
+   }
+
+   // the old copies of the bands that change and the old directory are dead once the new ones are in the file
+   std::vector<int> bandsToEncode;
+   uint64_t replacedSize = bands.directorySize;
+   for (int band = 0; band < bandCount; ++band) {
+      if (bands.dirty[band]) {
+         bandsToEncode.push_back(band);
+         replacedSize += bands.bands[band].size();
+      }
+   }
+
+   // look for IDs the palette doesn't have yet on every worker, then add them in band order
+   std::vector<uint32_t> paletteIndex = getPaletteIndex(bands.palette);
+   std::vector<std::vector<blockid_t>> missingIds (bandsToEncode.size());
+
+   getThreadPool().run(bandsToEncode.size(), [&](int i) {
+      int minY = bandsToEncode[i] * worldBandRows;
+      findMissingIds(map, minY, std::min(map.sizeY, minY + worldBandRows), paletteIndex, missingIds[i]);
+   });
+
+   for (const std::vector<blockid_t> &ids: missingIds) {
+      for (blockid_t id: ids) {
+         if (paletteIndex[id] == noPaletteIndex) {
+            paletteIndex[id] = bands.palette.size();
+            bands.palette.push_back(id);
+         }
+      }
+   }
+
+   uint64_t appendedSize = 0;
+   getThreadPool().run(bandsToEncode.size(), [&](int i) {
+      int band = bandsToEncode[i];
+      int minY = band * worldBandRows;
+      bands.bands[band].clear();
+      encodeBand(map, minY, std::min(map.sizeY, minY + worldBandRows), paletteIndex, bands.bands[band]);
+   });
+   for (int band: bandsToEncode) {
+      appendedSize += bands.bands[band].size();
+   }
+   bands.dirty.assign(bandCount, false);
+
+   // The bands that changed and a new directory are appended to the file the last save or load left, as long as it's
+   // still that file and not too much of it would be dead. otherwise the world is written whole to a temporary file,
+   // which compacts it
+   std::error_code error;
+   uint64_t currentSize = std::filesystem::file_size(filename, error);
+   bool append = (cache && !bands.offsets.empty() && !error && currentSize == bands.fileSize);
+   append = append && bands.deadSize + replacedSize <= worldDeadSpaceLimit * (bands.fileSize + appendedSize);
+
+   // the time of day and moon phase are passed in, since autosaves write from another thread
+   WorldHeader header {fileVersion, playerSpawnPosition, position, creative, breath, hearts, maxHearts, map.sizeX, map.sizeY, zoom, timeOfDay, moonPhase, map.seed};
+   Item noItems [realInventorySlots];
+   const char *inventoryData = reinterpret_cast<const char*>(inventory ? inventory->items : noItems);
+   std::vector<std::string> noHistory;
+   const std::vector<std::string> &history = (console ? console->history : noHistory);
+   uint64_t writeSize = 0;
+
+   if (append) {
+      std::fstream file (filename, std::ios::in | std::ios::out | std::ios::binary);
+      file.seekp(bands.fileSize);
+
+      for (int band: bandsToEncode) {
+         bands.offsets[band] = bands.fileSize + writeSize;
+         file.write(bands.bands[band].data(), bands.bands[band].size());
+         writeSize += bands.bands[band].size();
+      }
+      uint64_t directoryOffset = bands.fileSize + writeSize;
+      writeDirectory(file, header, inventoryData, history, bands.palette, bands.offsets, bands.bands, map.biomes, map.furniture, droppedItems);
+      uint64_t fileEnd = file.tellp();
+      writeDirectoryOffset(file, directoryOffset);
+      file.close();
+
+      // whatever was appended before a failure is past the end the file points to, so the last save is still there
+      if (file.fail()) {
+         printf("saveWorldData: Failed to save world '%s', the last save was kept.\n", filename.c_str());
+         bands.offsets.clear();
+         return;
+      }
+      writeSize = fileEnd - bands.fileSize;
+      bands.deadSize += replacedSize;
+      bands.directorySize = fileEnd - directoryOffset;
+      bands.fileSize = fileEnd;
+   } else {
+      std::ofstream file (tempFilename, std::ios::binary);
+      if (!file.is_open()) {
+         printf("saveWorldData: Failed to save world '%s'.\n", filename.c_str());
+         return;
+      }
+      uint64_t directoryOffset = writeWorldFile(file, header, inventoryData, history, bands.palette, bands.bands, bands.offsets, map.biomes, map.furniture, droppedItems);
+
+      // everything's done, swap the new file in
+      if (!replaceWithTemporary(file, tempFilename, filename)) {
+         printf("saveWorldData: Failed to save world '%s', the last save was kept.\n", filename.c_str());
+         bands.offsets.clear();
+         return;
+      }
+      writeSize = std::filesystem::file_size(filename, error);
+      bands.fileSize = writeSize;
+      bands.directorySize = writeSize - directoryOffset;
+      bands.deadSize = 0;
+   }
+
+   auto end = std::chrono::steady_clock::now();
+   uint64_t fileSize = std::filesystem::file_size(filename, error);
+
+   WorldInfo info {name, fileVersion, map.sizeX, map.sizeY, (int64_t)std::time(nullptr), fileSize};
+   getThumbnail(map, info);
+   {
+      std::lock_guard<std::mutex> lock (worldIndexMutex);
+      loadWorldIndex();
+      setWorldInfo(info);
+      saveWorldIndex();
+   }
+   printf("Successfully wrote %lluB (%lluKB) to '%s', encoded %d of %d bands and %s. Took %lldms.\n", (unsigned long long)writeSize, (unsigned long long)writeSize / 1000, filename.c_str(), (int)bandsToEncode.size(), bandCount, (append ? "appended them" : "rewrote the file"), (long long)std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count());
+}
+
+// Save cache functions
+
+// rows minY to maxY - 1 changed
+void WorldBands::markDirty(int minY, int maxY) {
+   for (int band = minY / worldBandRows; band <= (maxY - 1) / worldBandRows && band < (int)dirty.size(); ++band) {
+      dirty[band] = true;
+   }
+}
+
+// false if the world couldn't be read. the map is left empty then and the file must not be saved over. a cache is
+// filled in with the bands as they are in the file, so the next save only has to append what changed
+bool loadWorldData(const std::string &name, Player &player, float &zoom, Map &map, Console &console, Inventory &inventory, std::vector<DroppedItem> &droppedItems, WorldLoad *progressive, WorldBands *cache) {
+   auto begin = std::chrono::steady_clock::now();
+   std::string filename = "data/worlds/" + name + ".bin";
+
+   // worlds from older versions are rewritten in the current one first. reading any other layout as the current one
+   // would only give garbage
+   int versionOfFile = getFileVersion(name);
+   if (versionOfFile != fileVersion && !upgradeWorld(name)) {
+      printf("loadWorldData: World '%s' has version %d and couldn't be upgraded to %d.\n", filename.c_str(), versionOfFile, fileVersion);
+      return false;
+   }
+   auto mappedFile = std::make_unique<MappedFile>(filename);
+   size_t fileSize = mappedFile->size;
+
+   if (!mappedFile->data) {
       printf("loadWorldData: Failed to load world '%s'.\n", filename.c_str());
-      return;
+      return false;
    }
+   // everything but the bands is in the directory the head points to
+   WorldReader head {mappedFile->data, mappedFile->size};
+   int headVersion = 0;
+   uint64_t directoryOffset = 0;
+   head.read(reinterpret_cast<char*>(&headVersion), sizeof(headVersion));
+   head.read(reinterpret_cast<char*>(&directoryOffset), sizeof(directoryOffset));
+   directoryOffset = (head.failed || directoryOffset < worldHeadSize ? fileSize : std::min<uint64_t>(directoryOffset, fileSize));
+   WorldReader file {mappedFile->data + directoryOffset, fileSize - directoryOffset};
 
    // Read basic data
-   int versionOfFile = 0;
-   float timeofDay = 0;
-   int moonPhase = 0;
+   WorldHeader header;
+   readHeader(file, header);
 
-   file.read(reinterpret_cast<char*>(&versionOfFile), sizeof(versionOfFile));
-   file.read(reinterpret_cast<char*>(&player.spawnPos.x), sizeof(player.spawnPos.x));
-   file.read(reinterpret_cast<char*>(&player.spawnPos.y), sizeof(player.spawnPos.y));
-   file.read(reinterpret_cast<char*>(&player.position.x), sizeof(player.position.x));
-   file.read(reinterpret_cast<char*>(&player.position.y), sizeof(player.position.y));
-   file.read(reinterpret_cast<char*>(&player.creative), sizeof(player.creative));
-   file.read(reinterpret_cast<char*>(&player.breath), sizeof(player.breath));
-   file.read(reinterpret_cast<char*>(&player.hearts), sizeof(player.hearts));
-   file.read(reinterpret_cast<char*>(&player.maxHearts), sizeof(player.maxHearts));
-   file.read(reinterpret_cast<char*>(&map.sizeX), sizeof(map.sizeX));
-   file.read(reinterpret_cast<char*>(&map.sizeY), sizeof(map.sizeY));
-   file.read(reinterpret_cast<char*>(&zoom), sizeof(zoom));
-   file.read(reinterpret_cast<char*>(&timeofDay), sizeof(timeofDay));
-   file.read(reinterpret_cast<char*>(&moonPhase), sizeof(moonPhase));
-
-   setTimeOfDay(timeofDay);
-   setMoonPhase(moonPhase);
-   map.init();
+   if (file.failed || header.sizeX <= 0 || header.sizeY <= 0) {
+      printf("loadWorldData: World '%s' is corrupted.\n", filename.c_str());
+      map.sizeX = map.sizeY = 0;
+      return false;
+   }
+
+   player.spawnPos = header.spawnPosition;
+   player.position = header.position;
+   player.creative = header.creative;
+   player.breath = header.breath;
+   player.hearts = header.hearts;
+   player.maxHearts = header.maxHearts;
+   map.sizeX = header.sizeX;
+   map.sizeY = header.sizeY;
+   map.seed = header.seed;
+   zoom = header.zoom;
+   setTimeOfDay(header.timeOfDay);
+   setMoonPhase(header.moonPhase);
+
+   auto allocateBegin = std::chrono::steady_clock::now();
+   map.initContainers(); // render state is set up by whoever displays the map
+   auto allocateEnd = std::chrono::steady_clock::now();
 
    // Read inventory
    file.read(reinterpret_cast<char*>(&inventory.items), realInventorySlots * sizeof(Item));
 
    // Read console
-   size_t historySize = 0;
-   file.read(reinterpret_cast<char*>(&historySize), sizeof(historySize));
-   console.history.resize(historySize);
-
-   for (size_t i = 0; i < historySize; ++i) {
-      size_t lineSize = 0;
-      file.read(reinterpret_cast<char*>(&lineSize), sizeof(lineSize));
-      
-      std::string line;
-      line.resize(lineSize);
-      file.read(reinterpret_cast<char*>(line.data()), lineSize);
-      console.history[i] = line;
-   }
-
-   // read map. check saveWorldData for the compression algorithm in use
-   size_t blockSize = 0;
-   size_t wallSize = 0;
-   file.read(reinterpret_cast<char*>(&blockSize), sizeof(size_t));
-   file.read(reinterpret_cast<char*>(&wallSize), sizeof(size_t));
-
-   std::vector<blockid_t> blocks, walls;
-   blocks.resize(blockSize);
-   walls.resize(wallSize);
-
-   file.read(reinterpret_cast<char*>(blocks.data()), blocks.size() * sizeof(blockid_t));
-   file.read(reinterpret_cast<char*>(walls.data()), walls.size() * sizeof(blockid_t));
-
-   int blockCounter = 0;
-   for (size_t i = 0; i < blockSize; i += 2) {
-      blockid_t count = blocks[i];
-      blockid_t id = blocks[i+1];
-      map.fill(blockCounter, count, id);
-      blockCounter += count;
-   }
-
-   int wallCounter = 0;
-   for (size_t i = 0; i < wallSize; i += 2) {
-      blockid_t count = walls[i];
-      blockid_t id = walls[i+1];
-      map.fillWalls(wallCounter, count, id);
-      wallCounter += count;
-   }
-
-   // do the same with liquids...
-   size_t liquidTypeSize = 0;
-   size_t liquidHeightSize = 0;
-   file.read(reinterpret_cast<char*>(&liquidTypeSize), sizeof(size_t));
-   file.read(reinterpret_cast<char*>(&liquidHeightSize), sizeof(size_t));
-
-   std::vector<int> liquidTypes, liquidHeights;
-   liquidTypes.resize(liquidTypeSize);
-   liquidHeights.resize(liquidHeightSize);
-
-   file.read(reinterpret_cast<char*>(liquidTypes.data()), liquidTypes.size() * sizeof(int));
-   file.read(reinterpret_cast<char*>(liquidHeights.data()), liquidHeights.size() * sizeof(int));
-
-   int liquidTypeCounter = 0;
-   for (size_t i = 0; i < liquidTypeSize; i += 2) {
-      int count = liquidTypes[i];
-      int id = liquidTypes[i+1];
-      map.fillLiquids(liquidTypeCounter, count, id);
-      liquidTypeCounter += count;
-   }
-
-   int liquidHeightCounter = 0;
-   for (size_t i = 0; i < liquidHeightSize; i += 2) {
-      int count = liquidHeights[i];
-      int height = liquidHeights[i+1];
-      map.fillLiquidHeights(liquidHeightCounter, count, height);
-      liquidHeightCounter += count;
-   }
-
-   // Read furniture
-   size_t furnitureCount = 0;
-   file.read(reinterpret_cast<char*>(&furnitureCount), sizeof(furnitureCount));
-
-   for (size_t i = 0; i < furnitureCount; ++i) {
-      Furniture obj;
-      file.read(reinterpret_cast<char*>(&obj.id), sizeof(obj.id));
-      file.read(reinterpret_cast<char*>(&obj.x), sizeof(obj.x));
-      file.read(reinterpret_cast<char*>(&obj.y), sizeof(obj.y));
-      file.read(reinterpret_cast<char*>(&obj.width), sizeof(obj.width));
-      file.read(reinterpret_cast<char*>(&obj.height), sizeof(obj.height));
-      file.read(reinterpret_cast<char*>(&obj.flipped), sizeof(obj.flipped));
-      file.read(reinterpret_cast<char*>(&obj.ivalue1), sizeof(obj.ivalue1));
-      file.read(reinterpret_cast<char*>(&obj.ivalue2), sizeof(obj.ivalue2));
-      file.read(reinterpret_cast<char*>(&obj.fvalue1), sizeof(obj.fvalue1));
-      file.read(reinterpret_cast<char*>(&obj.fvalue2), sizeof(obj.fvalue2));
+   readStrings(file, fileVersion, console.history);
+   auto headerEnd = std::chrono::steady_clock::now();
 
-      obj.pieces.resize(obj.width * obj.height);
-      file.read(reinterpret_cast<char*>(obj.pieces.data()), obj.pieces.size() * sizeof(FurniturePiece));
-      map.addFurniture(obj);
+   // Find the map. check saveWorldData for the compression algorithm in use. the palette is turned from names into
+   // the IDs blocks have now, so the runs are remapped while they're expanded
+   std::vector<std::string> paletteNames;
+   readStrings(file, fileVersion, paletteNames);
+   std::vector<blockid_t> palette;
+
+   for (const std::string &blockName: paletteNames) {
+      if (!isBlockNameValid(blockName)) {
+         printf("loadWorldData: Block '%s' does not exist anymore, it's replaced with air.\n", blockName.c_str());
+      }
+      palette.push_back(isBlockNameValid(blockName) ? getBlockIdFromName(blockName) : 0);
    }
 
-   // and read dropped items
-   size_t droppedItemCount = 0;
-   file.read(reinterpret_cast<char*>(&droppedItemCount), sizeof(droppedItemCount));
-   droppedItems.resize(droppedItemCount);
+   int bandRows = 0, bandCount = 0;
+   file.read(reinterpret_cast<char*>(&bandRows), sizeof(bandRows));
+   file.read(reinterpret_cast<char*>(&bandCount), sizeof(bandCount));
+   bandCount = (file.failed || bandRows <= 0 || bandCount < 0 || size_t(bandCount) > file.size / sizeof(uint64_t) ? 0 : bandCount);
+
+   std::vector<uint64_t> bandOffsets (bandCount, 0), bandSizes (bandCount, 0);
+   file.read(reinterpret_cast<char*>(bandOffsets.data()), bandOffsets.size() * sizeof(uint64_t));
+   file.read(reinterpret_cast<char*>(bandSizes.data()), bandSizes.size() * sizeof(uint64_t));
+   std::vector<BandRuns> bands (bandCount);
+   const int area = map.sizeX * map.sizeY;
+
+   for (int band = 0; band < (int)bands.size() && !file.failed; ++band) {
+      bands[band].begin = std::min<long long>(area, (long long)band * bandRows * map.sizeX);
+      bands[band].end = std::min<long long>(area, (long long)(band + 1) * bandRows * map.sizeX);
+      bool inside = (bandOffsets[band] >= worldHeadSize && bandOffsets[band] <= fileSize && bandSizes[band] <= fileSize - bandOffsets[band]);
+      const char *bandData = mappedFile->data + bandOffsets[band];
+      file.failed |= (!inside || !findBandRuns(bandData, bandData + bandSizes[band], bands[band]));
+   }
+
+   // Read biomes
+   file.read(reinterpret_cast<char*>(map.biomes.data()), map.biomes.size() * sizeof(BiomeColumn));
 
-   if (droppedItemCount > 0) {
-      file.read(reinterpret_cast<char*>(droppedItems.data()), droppedItemCount * sizeof(DroppedItem));
+   if (file.failed) {
+      printf("loadWorldData: World '%s' is corrupted.\n", filename.c_str());
+      map.sizeX = map.sizeY = 0;
+      return false;
+   }
+
+   // everything that isn't the head, a band or the directory was left behind by saves that appended bands
+   if (cache) {
+      cache->bands.assign(bandCount, {});
+      cache->dirty.assign(bandCount, false);
+      cache->palette = palette;
+      cache->offsets = bandOffsets;
+      cache->fileSize = fileSize;
+      cache->directorySize = fileSize - directoryOffset;
+      cache->deadSize = fileSize - worldHeadSize - cache->directorySize;
+
+      for (int band = 0; band < bandCount; ++band) {
+         cache->bands[band].assign(mappedFile->data + bandOffsets[band], mappedFile->data + bandOffsets[band] + bandSizes[band]);
+         cache->deadSize -= std::min(cache->deadSize, bandSizes[band]);
+      }
+
+      // bands of another height can't be appended to, the next save rewrites the file then
+      if (bandRows != worldBandRows) {
+         *cache = {};
+      }
+   }
+
+   // Decode every section of every band straight into the map, with the furniture and dropped items at the end of the
+   // file read at the same time. the time each section took is summed over whichever workers ran it. a progressive
+   // load only decodes the bands nearest to the player here
+   std::vector<int> bandOrder (bandCount);
+   std::iota(bandOrder.begin(), bandOrder.end(), 0);
+   int loadedBands = bandCount;
+
+   if (progressive) {
+      int playerBand = (int)header.position.y / bandRows;
+      std::stable_sort(bandOrder.begin(), bandOrder.end(), [&](int a, int b) { return std::abs(a - playerBand) < std::abs(b - playerBand); });
+      loadedBands = std::min(bandCount, progressiveLoadBands);
+   }
+
+   std::vector<Furniture> furniture;
+   std::atomic<long long> sectionTimes[(int)WorldSection::count] {};
+   int taskCount = loadedBands * tileSectionCount + 1;
+
+   getThreadPool().run(taskCount, [&](int task) {
+      auto taskBegin = std::chrono::steady_clock::now();
+      WorldSection section = WorldSection::furniture;
+
+      if (task == taskCount - 1) {
+         readFurniture(file, fileVersion, furniture, droppedItems);
+      } else {
+         section = WorldSection(task % tileSectionCount);
+         decodeBandSection(getTileLanes(map), bands[bandOrder[task / tileSectionCount]], palette, section);
+      }
+      sectionTimes[(int)section] += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - taskBegin).count();
+   });
+   auto tilesEnd = std::chrono::steady_clock::now();
+
+   if (loadedBands == bandCount) {
+      // Work out the planes and surface of the whole map in one go, instead of after every run like the fill functions
+      int rowBands = (map.sizeY + chunkSize - 1) / chunkSize;
+      getThreadPool().run(rowBands, [&](int band) {
+         map.rebuildPlanes(band * chunkSize, std::min(map.sizeY, (band + 1) * chunkSize));
+      });
+
+      int columnStrips = (map.sizeX + 63) / 64;
+      getThreadPool().run(columnStrips, [&](int strip) {
+         map.rebuildSurface(strip * 64, std::min(map.sizeX, (strip + 1) * 64) - 1);
+      });
+   } else {
+      // only for the bands that are in. the others are air until they're published, so the surface is found row by
+      // row over just these
+      getThreadPool().run(loadedBands, [&](int i) {
+         map.rebuildPlanes(bandOrder[i] * bandRows, std::min(map.sizeY, (bandOrder[i] + 1) * bandRows));
+      });
+
+      for (int i = 0; i < loadedBands; ++i) {
+         map.updateSurfaceRows(bandOrder[i] * bandRows, std::min(map.sizeY, (bandOrder[i] + 1) * bandRows));
+      }
+   }
+   auto planesEnd = std::chrono::steady_clock::now();
+
+   if (progressive) {
+      progressive->bandRows = bandRows;
+      progressive->bandsLeft = bandCount - loadedBands;
+      progressive->bandsLoaded.assign(bandCount, false);
+      for (int i = 0; i < loadedBands; ++i) {
+         progressive->bandsLoaded[bandOrder[i]] = true;
+      }
+      progressive->updateChunks(map, 0, map.sizeY);
+   }
+
+   for (Furniture &obj: furniture) {
+      if (!progressive || progressive->areRowsLoaded(obj.y, obj.y + obj.height)) {
+         map.addFurniture(obj);
+      } else {
+         progressive->furniture.push_back(std::move(obj));
+      }
    }
    player.init();
+   map.clearDirty(ChunkFlag::all); // everything we just filled matches the file
+
+   // the rest of a progressive load is decoded on its own thread, which keeps the file mapped until it's done
+   if (progressive && progressive->bandsLeft > 0) {
+      std::vector<int> bandsLeft (bandOrder.begin() + loadedBands, bandOrder.end());
+      progressive->thread = std::thread([progressive, mappedFile = std::move(mappedFile), bands = std::move(bands), palette = std::move(palette), bandsLeft = std::move(bandsLeft)]() {
+         for (int band: bandsLeft) {
+            if (progressive->cancelled) {
+               return;
+            }
+            DecodedBand decoded;
+            decoded.band = band;
+
+            // decoded from the start of its own lanes instead of where it goes in the map
+            BandRuns runs = bands[band];
+            int tiles = runs.end - runs.begin;
+            runs.begin = 0;
+            runs.end = tiles;
+
+            decoded.blocks.resize(tiles);
+            decoded.walls.resize(tiles);
+            decoded.liquidTypes.resize(tiles);
+            decoded.liquidHeights.resize(tiles);
+            for (int section = 0; section < tileSectionCount; ++section) {
+               decodeBandSection(getTileLanes(decoded), runs, palette, WorldSection(section));
+            }
+
+            std::lock_guard<std::mutex> lock (progressive->mutex);
+            progressive->decoded.push_back(std::move(decoded));
+         }
+      });
+   }
 
    // and that's done
    auto end = std::chrono::steady_clock::now();
-   file.close();
-   size_t writeSize = std::filesystem::file_size(filename);
-   printf("Successfully read %lluB (%lluKB) from '%s'. Took %lldms.\n", writeSize, writeSize / 1000, filename.c_str(), std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count());
+   printf("Successfully read %lluB (%lluKB) from '%s'. Took %lldms", (unsigned long long)fileSize, (unsigned long long)fileSize / 1000, filename.c_str(), (long long)std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count());
+   printf(loadedBands == bandCount ? ".\n" : ", with %d of %d bands in and the rest loading in the background.\n", loadedBands, bandCount);
+   printf("   header %.2fms, allocating %.2fms, sections %.2fms (", getMilliseconds(begin, allocateBegin) + getMilliseconds(allocateEnd, headerEnd), getMilliseconds(allocateBegin, allocateEnd), getMilliseconds(headerEnd, tilesEnd));
+   for (int section = 0; section < (int)WorldSection::count; ++section) {
+      printf("%s%s %.2fms", (section == 0 ? "" : ", "), worldSectionNames[section], sectionTimes[section] / 1000.0f);
+   }
+   printf(" over %d threads), planes %.2fms, placing furniture %.2fms.\n", getThreadPool().getThreadCount(), getMilliseconds(tilesEnd, planesEnd), getMilliseconds(planesEnd, end));
+   return true;
+}
+
+// Progressive load functions
+
+WorldLoad::~WorldLoad() {
+   cancelled = true;
+   if (thread.joinable()) {
+      thread.join();
+   }
+}
+
+// puts the bands the thread finished into the map, nearest first, until budget milliseconds are used up. at least one
+// goes in every time. true once every band is in
+bool WorldLoad::publish(Map &map, float budget) {
+   auto begin = std::chrono::steady_clock::now();
+
+   while (bandsLeft > 0) {
+      DecodedBand band;
+      {
+         std::lock_guard<std::mutex> lock (mutex);
+         if (decoded.empty()) {
+            break;
+         }
+         band = std::move(decoded.front());
+         decoded.pop_front();
+      }
+      publishBand(map, band);
+
+      if (getMilliseconds(begin, std::chrono::steady_clock::now()) >= budget) {
+         break;
+      }
+   }
+   return bandsLeft == 0;
+}
+
+// everything left, for when the whole world is needed right now
+void WorldLoad::finish(Map &map) {
+   if (thread.joinable()) {
+      thread.join();
+   }
+   publish(map, std::numeric_limits<float>::max());
+}
+
+void WorldLoad::publishBand(Map &map, DecodedBand &band) {
+   int minY = band.band * bandRows;
+   int maxY = std::min(map.sizeY, minY + bandRows);
+   int i = minY * map.sizeX;
+
+   std::copy(band.blocks.begin(), band.blocks.end(), map.blocks.begin() + i);
+   std::copy(band.walls.begin(), band.walls.end(), map.walls.begin() + i);
+   std::copy(band.liquidTypes.begin(), band.liquidTypes.end(), map.liquidTypes.begin() + i);
+   std::copy(band.liquidHeights.begin(), band.liquidHeights.end(), map.liquidHeights.begin() + i);
+   map.rebuildPlanes(minY, maxY);
+   map.updateSurfaceRows(minY, maxY);
+
+   bandsLoaded[band.band] = true;
+   bandsLeft -= 1;
+   updateChunks(map, minY, maxY);
+
+   // furniture goes in once all of its rows are
+   for (Furniture &obj: furniture) {
+      if (areRowsLoaded(obj.y, obj.y + obj.height)) {
+         map.addFurniture(obj);
+         obj.id = 0;
+      }
+   }
+   furniture.erase(std::remove_if(furniture.begin(), furniture.end(), [](const Furniture &obj) { return obj.id == 0; }), furniture.end());
+}
+
+// a chunk is loaded once every band it overlaps is
+void WorldLoad::updateChunks(Map &map, int minY, int maxY) {
+   for (int chunkY = minY / chunkSize; chunkY < map.chunksY && chunkY * chunkSize < maxY; ++chunkY) {
+      bool loaded = areRowsLoaded(chunkY * chunkSize, std::min(map.sizeY, (chunkY + 1) * chunkSize));
+      for (int chunkX = 0; chunkX < map.chunksX; ++chunkX) {
+         map.setChunkLoaded(chunkX, chunkY, loaded);
+      }
+   }
+}
+
+bool WorldLoad::areRowsLoaded(int minY, int maxY) const {
+   for (int band = std::max(0, minY) / bandRows; band <= (maxY - 1) / bandRows && band < (int)bandsLoaded.size(); ++band) {
+      if (!bandsLoaded[band]) {
+         return false;
+      }
+   }
+   return true;
+}
+
+bool WorldLoad::isDone() const {
+   return bandsLeft == 0;
+}
+
+// Upgrade functions
+
+// Walks one lane of the runs of an old world, pairs of (count, value) stored as T, across all of its bands
+template<class T>
+struct LegacyRuns {
+   // the value of the current run and how many of its tiles are left, at most max. 0 once the runs are used up
+   int peek(int max, uint32_t &value) {
+      while (remaining == 0) {
+         if (segment == segments.size()) {
+            return 0;
+         }
+
+         auto [data, count] = segments[segment];
+         if (run + 1 >= count) {
+            segment += 1;
+            run = 0;
+            continue;
+         }
+
+         T pair[2];
+         std::memcpy(pair, data + run * sizeof(T), sizeof(pair));
+         remaining = std::max<long long>(pair[0], 0);
+         current = pair[1];
+         run += 2;
+      }
+      value = current;
+      return (int)std::min<long long>(remaining, max);
+   }
+
+   void skip(int count) {
+      remaining -= count;
+   }
+
+   std::vector<std::pair<const char*, size_t>> segments;
+   size_t segment = 0;
+   size_t run = 0;
+   long long remaining = 0;
+   uint32_t current = 0;
+};
+
+// The four run lists of a world saved before version 17
+struct LegacyMap {
+   LegacyRuns<blockid_t> blocks, walls;
+   LegacyRuns<int> liquidTypes, liquidHeights;
+};
+
+// version 16 split the runs into bands of rows with an index in front, older worlds are one band with the four run
+// lists and their sizes in a different order
+static void readLegacyMap(WorldReader &file, int version, LegacyMap &map) {
+   auto addRuns = [&](WorldReader &reader, const size_t *counts) {
+      map.blocks.segments.emplace_back(reader.take(counts[0] * sizeof(blockid_t)), counts[0]);
+      map.walls.segments.emplace_back(reader.take(counts[1] * sizeof(blockid_t)), counts[1]);
+      map.liquidTypes.segments.emplace_back(reader.take(counts[2] * sizeof(int)), counts[2]);
+      map.liquidHeights.segments.emplace_back(reader.take(counts[3] * sizeof(int)), counts[3]);
+   };
+
+   if (version >= 16) {
+      int bandRows = 0, bandCount = 0;
+      file.read(reinterpret_cast<char*>(&bandRows), sizeof(bandRows));
+      file.read(reinterpret_cast<char*>(&bandCount), sizeof(bandCount));
+      bandCount = (file.failed || bandCount < 0 || size_t(bandCount) > file.size / sizeof(size_t) ? 0 : bandCount);
+
+      std::vector<size_t> bandOffsets (bandCount + 1, 0);
+      file.read(reinterpret_cast<char*>(bandOffsets.data()), bandOffsets.size() * sizeof(size_t));
+      const char *bandData = file.take(bandOffsets.back());
+
+      for (int band = 0; band < bandCount && bandData; ++band) {
+         WorldReader reader {bandData, bandOffsets.back(), std::min(bandOffsets[band], bandOffsets.back())};
+         size_t counts[4] {};
+         reader.read(reinterpret_cast<char*>(counts), sizeof(counts));
+         addRuns(reader, counts);
+         file.failed |= reader.failed;
+      }
+   } else {
+      size_t counts[4] {};
+      file.read(reinterpret_cast<char*>(&counts[0]), sizeof(size_t));
+      file.read(reinterpret_cast<char*>(&counts[1]), sizeof(size_t));
+      const char *blocks = file.take(counts[0] * sizeof(blockid_t));
+      const char *walls = file.take(counts[1] * sizeof(blockid_t));
+      file.read(reinterpret_cast<char*>(&counts[2]), sizeof(size_t));
+      file.read(reinterpret_cast<char*>(&counts[3]), sizeof(size_t));
+
+      map.blocks.segments.emplace_back(blocks, counts[0]);
+      map.walls.segments.emplace_back(walls, counts[1]);
+      map.liquidTypes.segments.emplace_back(file.take(counts[2] * sizeof(int)), counts[2]);
+      map.liquidHeights.segments.emplace_back(file.take(counts[3] * sizeof(int)), counts[3]);
+   }
+}
+
+// moves the runs of an old world straight into a palette and the new bands, without ever expanding the map into tiles
+static void convertLegacyMap(LegacyMap &map, int sizeX, int sizeY, std::vector<blockid_t> &palette, std::vector<std::vector<char>> &bands) {
+   // every ID the old runs use goes in the palette, air first like the saver does
+   palette = {0};
+   std::vector<uint32_t> paletteIndex = getPaletteIndex(palette);
+   for (const auto *lane: {&map.blocks.segments, &map.walls.segments}) {
+      for (auto [data, count]: *lane) {
+         for (size_t run = 0; run + 1 < count; run += 2) {
+            blockid_t id;
+            std::memcpy(&id, data + (run + 1) * sizeof(blockid_t), sizeof(id));
+            if (paletteIndex[id] == noPaletteIndex) {
+               paletteIndex[id] = palette.size();
+               palette.push_back(id);
+            }
+         }
+      }
+   }
+
+   // then the runs are cut into the new bands. whatever the old runs don't cover stays empty, like it did when the
+   // old loader read them
+   bands.assign((sizeY + worldBandRows - 1) / worldBandRows, {});
+
+   for (int band = 0; band < (int)bands.size(); ++band) {
+      int tiles = (std::min(sizeY, (band + 1) * worldBandRows) - band * worldBandRows) * sizeX;
+      std::vector<char> blocks, walls, liquids;
+      RunWriter blockWriter {blocks}, wallWriter {walls}, liquidWriter {liquids};
+
+      auto copyRuns = [&](auto &runs, RunWriter &writer) {
+         uint32_t id = 0;
+         int n = 0;
+         for (int left = tiles; left > 0; left -= n) {
+            if ((n = runs.peek(left, id)) == 0) {
+               writer.push(0, left);
+               break;
+            }
+            writer.push(paletteIndex[id], n);
+            runs.skip(n);
+         }
+         writer.flush();
+      };
+      copyRuns(map.blocks, blockWriter);
+      copyRuns(map.walls, wallWriter);
+
+      // types and heights were separate runs, a tile's liquid changes wherever either of them does
+      uint32_t type = 0, height = 0;
+      int n = 0;
+      for (int left = tiles; left > 0; left -= n) {
+         n = std::min(map.liquidTypes.peek(left, type), map.liquidHeights.peek(left, height));
+         if (n == 0) {
+            liquidWriter.push(0, left);
+            break;
+         }
+         liquidWriter.push(packLiquid(type, height), n);
+         map.liquidTypes.skip(n);
+         map.liquidHeights.skip(n);
+      }
+      liquidWriter.flush();
+      appendBand(bands[band], blocks, walls, liquids);
+   }
+}
+
+// versions 17 and 18 had the bands of today, but one after another right behind an index of where each one starts
+static void readIndexedBands(WorldReader &file, std::vector<std::vector<char>> &bands) {
+   int bandRows = 0, bandCount = 0;
+   file.read(reinterpret_cast<char*>(&bandRows), sizeof(bandRows));
+   file.read(reinterpret_cast<char*>(&bandCount), sizeof(bandCount));
+   bandCount = (file.failed || bandCount < 0 || size_t(bandCount) > file.size / sizeof(uint64_t) ? 0 : bandCount);
+   file.failed |= (bandRows != worldBandRows);
+
+   std::vector<uint64_t> bandOffsets (bandCount + 1, 0);
+   file.read(reinterpret_cast<char*>(bandOffsets.data()), bandOffsets.size() * sizeof(uint64_t));
+   const char *bandData = file.take(bandOffsets.back());
+   bands.assign(bandData ? bandCount : 0, {});
+
+   for (int band = 0; band < (int)bands.size(); ++band) {
+      if (bandOffsets[band] > bandOffsets[band + 1] || bandOffsets[band + 1] > bandOffsets.back()) {
+         file.failed = true;
+         return;
+      }
+      bands[band].assign(bandData + bandOffsets[band], bandData + bandOffsets[band + 1]);
+   }
+}
+
+// version 17 had a palette of block IDs instead of names
+static void readIdPaletteMap(WorldReader &file, std::vector<blockid_t> &palette, std::vector<std::vector<char>> &bands) {
+   uint32_t paletteSize = 0;
+   file.read(reinterpret_cast<char*>(&paletteSize), sizeof(paletteSize));
+   palette.resize(file.failed || paletteSize > file.size / sizeof(blockid_t) ? 0 : paletteSize);
+   file.read(reinterpret_cast<char*>(palette.data()), palette.size() * sizeof(blockid_t));
+   readIndexedBands(file, bands);
+}
+
+// version 18 had the palette of today, blocks that don't exist anymore become air like when loading
+static void readNamePaletteMap(WorldReader &file, std::vector<blockid_t> &palette, std::vector<std::vector<char>> &bands) {
+   std::vector<std::string> paletteNames;
+   readStrings(file, 18, paletteNames);
+   for (const std::string &blockName: paletteNames) {
+      palette.push_back(isBlockNameValid(blockName) ? getBlockIdFromName(blockName) : 0);
+   }
+   readIndexedBands(file, bands);
+}
+
+// rewrites a world saved by versions 13 to 18 in the current format. the IDs in old worlds are taken to still mean
+// the blocks they mean in blocks.txt now, since those worlds never said which blocks they were
+bool upgradeWorld(const std::string &name) {
+   auto begin = std::chrono::steady_clock::now();
+   std::string filename = "data/worlds/" + name + ".bin";
+   std::string tempFilename = filename + ".tmp";
+   int versionOfFile = getFileVersion(name);
+
+   if (versionOfFile == fileVersion) {
+      return true;
+   }
+
+   if (versionOfFile < oldestUpgradableVersion || versionOfFile > fileVersion) {
+      printf("upgradeWorld: World '%s' has version %d, only versions %d to %d can be upgraded.\n", filename.c_str(), versionOfFile, oldestUpgradableVersion, fileVersion - 1);
+      return false;
+   }
+   std::ofstream out (tempFilename, std::ios::binary);
+
+   if (!out.is_open()) {
+      printf("upgradeWorld: Failed to write world '%s'.\n", tempFilename.c_str());
+      return false;
+   }
+
+   // the mapping has to be gone before the new file replaces it, windows won't rename over a mapped file
+   {
+      MappedFile mappedFile (filename);
+      WorldReader file {mappedFile.data, mappedFile.size};
+
+      WorldHeader header;
+      readHeader(file, header);
+      const char *inventory = file.take(realInventorySlots * sizeof(Item));
+      std::vector<std::string> history;
+      readStrings(file, versionOfFile, history);
+
+      std::vector<blockid_t> palette;
+      std::vector<std::vector<char>> bands;
+      LegacyMap legacyMap;
+      if (versionOfFile >= 18) {
+         readNamePaletteMap(file, palette, bands);
+      } else if (versionOfFile >= 17) {
+         readIdPaletteMap(file, palette, bands);
+      } else {
+         readLegacyMap(file, versionOfFile, legacyMap);
+      }
+
+      // version 15 added biomes, older worlds stay plains everywhere
+      std::vector<BiomeColumn> biomes (std::max(header.sizeX, 0), BiomeColumn{});
+      if (versionOfFile >= 15) {
+         file.read(reinterpret_cast<char*>(biomes.data()), biomes.size() * sizeof(BiomeColumn));
+      }
+
+      std::vector<Furniture> furniture;
+      std::vector<DroppedItem> droppedItems;
+      readFurniture(file, versionOfFile, furniture, droppedItems);
+
+      if (file.failed || !inventory || header.sizeX <= 0 || header.sizeY <= 0) {
+         printf("upgradeWorld: World '%s' is corrupted.\n", filename.c_str());
+         out.close();
+         std::error_code error;
+         std::filesystem::remove(tempFilename, error);
+         return false;
+      }
+
+      if (versionOfFile < 17) {
+         convertLegacyMap(legacyMap, header.sizeX, header.sizeY, palette, bands);
+      }
+
+      header.version = fileVersion;
+      std::vector<uint64_t> bandOffsets;
+      writeWorldFile(out, header, inventory, history, palette, bands, bandOffsets, biomes, furniture, &droppedItems);
+   }
+
+   if (!replaceWithTemporary(out, tempFilename, filename)) {
+      printf("upgradeWorld: Failed to upgrade world '%s', it was left as it was.\n", filename.c_str());
+      return false;
+   }
+
+   // keeps the thumbnail and last played time, only the file changed
+   {
+      std::lock_guard<std::mutex> lock (worldIndexMutex);
+      loadWorldIndex();
+      auto info = findWorldInfo(name);
+      std::error_code error;
+
+      if (info != worldIndex.end()) {
+         info->version = fileVersion;
+         info->fileSize = std::filesystem::file_size(filename, error);
+         saveWorldIndex();
+      }
+   }
+
+   auto end = std::chrono::steady_clock::now();
+   printf("Upgraded world '%s' from version %d to %d. Took %lldms.\n", filename.c_str(), versionOfFile, fileVersion, (long long)std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count());
+   return true;
 }
 
 // delete a world
@@ -360,13 +1416,51 @@ bool deleteWorld(const std::string &name) {
    uintmax_t deleteCount = std::filesystem::remove_all(filename);
 
    if (deleteCount > 0) {
-      printf("Successfully deleted world '%s' (%lluKB).\n", filename.c_str(), size / 1000);
+      std::lock_guard<std::mutex> lock (worldIndexMutex);
+      loadWorldIndex();
+      auto info = findWorldInfo(name);
+
+      if (info != worldIndex.end()) {
+         worldIndex.erase(info);
+         saveWorldIndex();
+      }
+      printf("Successfully deleted world '%s' (%lluKB).\n", filename.c_str(), (unsigned long long)size / 1000);
       return true;
    }
    printf("Failed to delete world '%s'.\n", filename.c_str());
    return false;
 }
 
+bool renameWorld(const std::string &name, const std::string &newName) {
+   std::string filename = "data/worlds/" + name + ".bin";
+   std::string newFilename = "data/worlds/" + newName + ".bin";
+   std::error_code error;
+   std::filesystem::rename(filename, newFilename, error);
+
+   if (error) {
+      printf("Failed to rename world '%s' to '%s'.\n", filename.c_str(), newFilename.c_str());
+      return false;
+   }
+
+   std::lock_guard<std::mutex> lock (worldIndexMutex);
+   loadWorldIndex();
+   auto info = findWorldInfo(name);
+   WorldInfo renamed;
+
+   if (info != worldIndex.end()) {
+      renamed = *info;
+      worldIndex.erase(info);
+      renamed.name = newName;
+      setWorldInfo(renamed);
+   } else {
+      readWorldInfo(newName, renamed);
+      setWorldInfo(renamed);
+   }
+   saveWorldIndex();
+   printf("Successfully renamed world '%s' to '%s'.\n", filename.c_str(), newFilename.c_str());
+   return true;
+}
+
 int getFileVersion(const std::string &name) {
    std::ifstream file ("data/worlds/" + name + ".bin", std::ios::binary);
    if (!file.is_open()) {
@@ -382,3 +1476,50 @@ int getFileVersion(const std::string &name) {
 int getLatestVersion() {
    return fileVersion;
 }
+
+// World index functions
+
+std::vector<WorldInfo> getWorldIndex() {
+   std::lock_guard<std::mutex> lock (worldIndexMutex);
+   loadWorldIndex();
+   return worldIndex;
+}
+
+// Catches up with worlds copied in or removed while the game wasn't looking. only lists the folder, the worlds
+// themselves are only opened if the index doesn't know them or their size changed
+void syncWorldIndex() {
+   std::lock_guard<std::mutex> lock (worldIndexMutex);
+   loadWorldIndex();
+   std::filesystem::create_directories("data/worlds/");
+
+   std::vector<WorldInfo> synced;
+   bool changed = false;
+   std::error_code error;
+
+   for (const auto &file: std::filesystem::directory_iterator("data/worlds", error)) {
+      if (file.path().extension() != ".bin") {
+         continue; // leftovers of interrupted saves
+      }
+      std::string name = file.path().stem().string();
+      auto info = findWorldInfo(name);
+
+      if (info != worldIndex.end() && info->fileSize == file.file_size(error)) {
+         synced.push_back(*info);
+         continue;
+      }
+      WorldInfo read;
+      readWorldInfo(name, read);
+
+      if (info != worldIndex.end()) {
+         read.thumbnail = info->thumbnail;
+      }
+      synced.push_back(read);
+      changed = true;
+   }
+   std::sort(synced.begin(), synced.end(), [](const WorldInfo &a, const WorldInfo &b) { return a.name < b.name; });
+
+   if (changed || synced.size() != worldIndex.size()) {
+      worldIndex = std::move(synced);
+      saveWorldIndex();
+   }
+}
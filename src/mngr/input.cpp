@@ -1,5 +1,5 @@
 #include "mngr/input.hpp"
-#include "SRU/audio.hpp"
+#include "mngr/assetHandles.hpp"
 #include <raylib.h>
 #include <array>
 
@@ -86,7 +86,7 @@ bool isKeyRepeated(int key) {
 bool handleKeyPressWithSound(int key) {
    bool pressed = isKeyPressed(key);
    if (pressed) {
-      playSound("click");
+      playSound(getAssetHandles().click);
    }
    return pressed;
 }
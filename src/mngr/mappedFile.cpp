@@ -0,0 +1,71 @@
+#include "mngr/mappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Constructors
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string &filename) {
+   HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+   if (file == INVALID_HANDLE_VALUE) {
+      return;
+   }
+   fileHandle = file;
+
+   LARGE_INTEGER fileSize;
+   if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+      return;
+   }
+
+   HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+   if (!mapping) {
+      return;
+   }
+   mappingHandle = mapping;
+
+   data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+   size = (data ? (size_t)fileSize.QuadPart : 0);
+}
+
+MappedFile::~MappedFile() {
+   if (data) UnmapViewOfFile(data);
+   if (mappingHandle) CloseHandle(mappingHandle);
+   if (fileHandle) CloseHandle(fileHandle);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string &filename) {
+   int file = open(filename.c_str(), O_RDONLY);
+   if (file < 0) {
+      return;
+   }
+
+   struct stat status;
+   if (fstat(file, &status) == 0 && status.st_size > 0) {
+      void *mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+      if (mapping != MAP_FAILED) {
+         data = static_cast<const char*>(mapping);
+         size = status.st_size;
+      }
+   }
+   close(file); // the mapping keeps the file around on its own
+}
+
+MappedFile::~MappedFile() {
+   if (data) {
+      munmap(const_cast<char*>(data), size);
+   }
+}
+
+#endif
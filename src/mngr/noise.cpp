@@ -0,0 +1,322 @@
+#include "mngr/noise.hpp"
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define NOISE_SSE2
+#endif
+
+#if defined(NOISE_SSE2) && defined(__GNUC__)
+#define NOISE_AVX2
+#endif
+
+using siv::perlin_detail::Fade;
+using siv::perlin_detail::Lerp;
+
+// Noise cells. within a lattice cell the gradient of every corner along a row is scale * x + offset, where x is the
+// tile's offset from that corner. both come from the hash of the corner, so the permutation lookups only happen once
+// per cell
+
+struct NoiseCell {
+   double scale[8];
+   double offset[8];
+};
+
+struct NoiseRow {
+   const NoiseCell *cells = nullptr;
+   int firstCell = 0;
+   double v = 0.0;
+   double w = 0.0;
+   double amplitude = 1.0;
+};
+
+// same cases as siv::perlin_detail::Grad. u is x for hashes below 8, v is x for 12 and 14. the two never overlap, so at
+// most one of them scales with x and the sum is exactly what Grad returns
+static void setGradient(double &scale, double &offset, int h, double y, double z) {
+   const double signU = ((h & 1) == 0 ? 1.0 : -1.0);
+   const double signV = ((h & 2) == 0 ? 1.0 : -1.0);
+
+   if (h < 8) {
+      scale = signU;
+      offset = signV * (h < 4 ? y : z);
+   } else if (h == 12 || h == 14) {
+      scale = signV;
+      offset = signU * y;
+   } else {
+      scale = 0.0;
+      offset = signU * y + signV * z;
+   }
+}
+
+static void buildCells(const siv::PerlinNoise::state_type &permutation, int firstCell, int lastCell, double y, std::vector<NoiseCell> &cells, NoiseRow &row) {
+   const double z = static_cast<double>(SIVPERLIN_DEFAULT_Z);
+   const double floorY = std::floor(y);
+   const double floorZ = std::floor(z);
+   const int iy = static_cast<std::int32_t>(floorY) & 255;
+   const int iz = static_cast<std::int32_t>(floorZ) & 255;
+   const double fy = y - floorY;
+   const double fz = z - floorZ;
+
+   // y and z are the same for the whole row, so every corner only has 16 possible gradients. work them out up front
+   // and let the cells look them up by hash instead of branching on it
+   NoiseCell gradients[16];
+   for (int h = 0; h < 16; ++h) {
+      for (int corner = 0; corner < 8; ++corner) {
+         setGradient(gradients[h].scale[corner], gradients[h].offset[corner], h, (corner & 2 ? fy - 1 : fy), (corner & 4 ? fz - 1 : fz));
+      }
+   }
+
+   cells.resize(lastCell - firstCell + 1);
+   for (int cell = firstCell; cell <= lastCell; ++cell) {
+      const int ix = cell & 255;
+      const std::uint8_t A = (permutation[ix] + iy) & 255;
+      const std::uint8_t B = (permutation[(ix + 1) & 255] + iy) & 255;
+      const std::uint8_t AA = (permutation[A] + iz) & 255;
+      const std::uint8_t AB = (permutation[(A + 1) & 255] + iz) & 255;
+      const std::uint8_t BA = (permutation[B] + iz) & 255;
+      const std::uint8_t BB = (permutation[(B + 1) & 255] + iz) & 255;
+      const std::uint8_t hashes[8] = {
+         permutation[AA], permutation[BA], permutation[AB], permutation[BB],
+         permutation[(AA + 1) & 255], permutation[(BA + 1) & 255], permutation[(AB + 1) & 255], permutation[(BB + 1) & 255],
+      };
+
+      NoiseCell &data = cells[cell - firstCell];
+      for (int corner = 0; corner < 8; ++corner) {
+         const NoiseCell &gradient = gradients[hashes[corner] & 15];
+         data.scale[corner] = gradient.scale[corner];
+         data.offset[corner] = gradient.offset[corner];
+      }
+   }
+
+   row.cells = cells.data();
+   row.firstCell = firstCell;
+   row.v = Fade(fy);
+   row.w = Fade(fz);
+}
+
+// Kernels. each adds one octave of noise times the row's amplitude to sums[begin] up to sums[end - 1] and returns
+// where it stopped, the scalar kernel picks up whatever doesn't fill a whole vector
+
+static int addOctaveScalar(const NoiseRow &row, const double *xs, double *sums, int begin, int end) {
+   for (int i = begin; i < end; ++i) {
+      const double floorX = std::floor(xs[i]);
+      const double fx = xs[i] - floorX;
+      const double fx1 = fx - 1;
+      const NoiseCell &cell = row.cells[static_cast<std::int32_t>(floorX) - row.firstCell];
+      const double u = Fade(fx);
+
+      const double q0 = Lerp(cell.scale[0] * fx + cell.offset[0], cell.scale[1] * fx1 + cell.offset[1], u);
+      const double q1 = Lerp(cell.scale[2] * fx + cell.offset[2], cell.scale[3] * fx1 + cell.offset[3], u);
+      const double q2 = Lerp(cell.scale[4] * fx + cell.offset[4], cell.scale[5] * fx1 + cell.offset[5], u);
+      const double q3 = Lerp(cell.scale[6] * fx + cell.offset[6], cell.scale[7] * fx1 + cell.offset[7], u);
+      const double r0 = Lerp(q0, q1, row.v);
+      const double r1 = Lerp(q2, q3, row.v);
+      sums[i] += Lerp(r0, r1, row.w) * row.amplitude;
+   }
+   return end;
+}
+
+#ifdef NOISE_SSE2
+
+// sse2 has no floor, truncate and step down where that rounded up. the tile coordinates always fit an int
+static inline __m128d floorSse2(__m128d x) {
+   const __m128d truncated = _mm_cvtepi32_pd(_mm_cvttpd_epi32(x));
+   return _mm_sub_pd(truncated, _mm_and_pd(_mm_cmpgt_pd(truncated, x), _mm_set1_pd(1.0)));
+}
+
+static inline __m128d fadeSse2(__m128d t) {
+   const __m128d cube = _mm_mul_pd(_mm_mul_pd(t, t), t);
+   const __m128d inner = _mm_add_pd(_mm_mul_pd(t, _mm_sub_pd(_mm_mul_pd(t, _mm_set1_pd(6.0)), _mm_set1_pd(15.0))), _mm_set1_pd(10.0));
+   return _mm_mul_pd(cube, inner);
+}
+
+static inline __m128d lerpSse2(__m128d a, __m128d b, __m128d t) {
+   return _mm_add_pd(a, _mm_mul_pd(_mm_sub_pd(b, a), t));
+}
+
+static int addOctaveSse2(const NoiseRow &row, const double *xs, double *sums, int begin, int end) {
+   const __m128d one = _mm_set1_pd(1.0);
+   const __m128d v = _mm_set1_pd(row.v);
+   const __m128d w = _mm_set1_pd(row.w);
+   const __m128d amplitude = _mm_set1_pd(row.amplitude);
+
+   int i = begin;
+   for (; i + 2 <= end; i += 2) {
+      const __m128d x = _mm_loadu_pd(xs + i);
+      const __m128d floorX = floorSse2(x);
+      const __m128d fx = _mm_sub_pd(x, floorX);
+      const __m128d fx1 = _mm_sub_pd(fx, one);
+      const __m128d u = fadeSse2(fx);
+
+      const __m128i cellIndex = _mm_cvttpd_epi32(floorX);
+      const NoiseCell &cell0 = row.cells[_mm_cvtsi128_si32(cellIndex) - row.firstCell];
+      const NoiseCell &cell1 = row.cells[_mm_cvtsi128_si32(_mm_shuffle_epi32(cellIndex, 1)) - row.firstCell];
+
+      __m128d p[8];
+      for (int corner = 0; corner < 8; ++corner) {
+         const __m128d scale = _mm_set_pd(cell1.scale[corner], cell0.scale[corner]);
+         const __m128d offset = _mm_set_pd(cell1.offset[corner], cell0.offset[corner]);
+         p[corner] = _mm_add_pd(_mm_mul_pd(scale, (corner & 1 ? fx1 : fx)), offset);
+      }
+
+      const __m128d r0 = lerpSse2(lerpSse2(p[0], p[1], u), lerpSse2(p[2], p[3], u), v);
+      const __m128d r1 = lerpSse2(lerpSse2(p[4], p[5], u), lerpSse2(p[6], p[7], u), v);
+      const __m128d sum = _mm_add_pd(_mm_loadu_pd(sums + i), _mm_mul_pd(lerpSse2(r0, r1, w), amplitude));
+      _mm_storeu_pd(sums + i, sum);
+   }
+   return i;
+}
+
+#endif
+
+#ifdef NOISE_AVX2
+
+// no fma in the target list on purpose, fused multiply adds would round differently than the scalar calls
+
+__attribute__((target("avx2"))) static inline __m256d fadeAvx2(__m256d t) {
+   const __m256d cube = _mm256_mul_pd(_mm256_mul_pd(t, t), t);
+   const __m256d inner = _mm256_add_pd(_mm256_mul_pd(t, _mm256_sub_pd(_mm256_mul_pd(t, _mm256_set1_pd(6.0)), _mm256_set1_pd(15.0))), _mm256_set1_pd(10.0));
+   return _mm256_mul_pd(cube, inner);
+}
+
+__attribute__((target("avx2"))) static inline __m256d lerpAvx2(__m256d a, __m256d b, __m256d t) {
+   return _mm256_add_pd(a, _mm256_mul_pd(_mm256_sub_pd(b, a), t));
+}
+
+__attribute__((target("avx2"))) static int addOctaveAvx2(const NoiseRow &row, const double *xs, double *sums, int begin, int end) {
+   const __m256d zero = _mm256_setzero_pd();
+   const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+   const __m256d one = _mm256_set1_pd(1.0);
+   const __m256d v = _mm256_set1_pd(row.v);
+   const __m256d w = _mm256_set1_pd(row.w);
+   const __m256d amplitude = _mm256_set1_pd(row.amplitude);
+   const __m128i firstCell = _mm_set1_epi32(row.firstCell);
+   const double *scales = row.cells[0].scale;
+   const double *offsets = row.cells[0].offset;
+   constexpr int cellStride = sizeof(NoiseCell) / sizeof(double);
+
+   int i = begin;
+   for (; i + 4 <= end; i += 4) {
+      const __m256d x = _mm256_loadu_pd(xs + i);
+      const __m256d floorX = _mm256_floor_pd(x);
+      const __m256d fx = _mm256_sub_pd(x, floorX);
+      const __m256d fx1 = _mm256_sub_pd(fx, one);
+      const __m256d u = fadeAvx2(fx);
+
+      // cell index times the doubles per cell, for the gathers
+      const __m128i cellIndex = _mm_sub_epi32(_mm256_cvttpd_epi32(floorX), firstCell);
+      const __m128i index = _mm_mullo_epi32(cellIndex, _mm_set1_epi32(cellStride));
+
+      __m256d p[8];
+      for (int corner = 0; corner < 8; ++corner) {
+         const __m256d scale = _mm256_mask_i32gather_pd(zero, scales + corner, index, all, 8);
+         const __m256d offset = _mm256_mask_i32gather_pd(zero, offsets + corner, index, all, 8);
+         p[corner] = _mm256_add_pd(_mm256_mul_pd(scale, (corner & 1 ? fx1 : fx)), offset);
+      }
+
+      const __m256d r0 = lerpAvx2(lerpAvx2(p[0], p[1], u), lerpAvx2(p[2], p[3], u), v);
+      const __m256d r1 = lerpAvx2(lerpAvx2(p[4], p[5], u), lerpAvx2(p[6], p[7], u), v);
+      const __m256d sum = _mm256_add_pd(_mm256_loadu_pd(sums + i), _mm256_mul_pd(lerpAvx2(r0, r1, w), amplitude));
+      _mm256_storeu_pd(sums + i, sum);
+   }
+   return i;
+}
+
+#endif
+
+// Kernel functions
+
+bool isNoiseKernelSupported(NoiseKernel kernel) {
+   switch (kernel) {
+#ifdef NOISE_SSE2
+   case NoiseKernel::sse2: return true;
+#endif
+#ifdef NOISE_AVX2
+   case NoiseKernel::avx2: return __builtin_cpu_supports("avx2");
+#endif
+   case NoiseKernel::scalar: return true;
+   default: return false;
+   }
+}
+
+NoiseKernel getNoiseKernel() {
+   static const NoiseKernel best = []() {
+      for (int kernel = (int)NoiseKernel::count - 1; kernel > 0; --kernel) {
+         if (isNoiseKernelSupported(NoiseKernel(kernel))) {
+            return NoiseKernel(kernel);
+         }
+      }
+      return NoiseKernel::scalar;
+   }();
+   return best;
+}
+
+const char *getNoiseKernelName(NoiseKernel kernel) {
+   switch (kernel) {
+   case NoiseKernel::scalar: return "scalar";
+   case NoiseKernel::sse2:   return "sse2";
+   case NoiseKernel::avx2:   return "avx2";
+   default:                  return "unknown";
+   }
+}
+
+// Batch functions
+
+void octave2DRow(const siv::PerlinNoise &noise, int x, int y, int count, float scale, int octaves, float *out, NoiseKernel kernel) {
+   if (count <= 0) {
+      return;
+   }
+
+   if (!isNoiseKernelSupported(kernel)) {
+      kernel = NoiseKernel::scalar;
+   }
+
+   // reused between calls so filling a row doesn't allocate
+   thread_local std::vector<double> xs, sums;
+   thread_local std::vector<NoiseCell> cells;
+   xs.resize(count);
+   sums.assign(count, 0.0);
+
+   // float coordinates like the `x * scale` callers pass, doubling them for every octave is exact
+   for (int i = 0; i < count; ++i) {
+      xs[i] = float(x + i) * scale;
+   }
+   double py = float(y) * scale;
+
+   NoiseRow row;
+   for (int octave = 0; octave < octaves; ++octave) {
+      int firstCell = static_cast<std::int32_t>(std::floor(std::min(xs.front(), xs.back())));
+      int lastCell = static_cast<std::int32_t>(std::floor(std::max(xs.front(), xs.back())));
+      buildCells(noise.serialize(), firstCell, lastCell, py, cells, row);
+
+      int done = 0;
+#ifdef NOISE_AVX2
+      if (kernel == NoiseKernel::avx2) {
+         done = addOctaveAvx2(row, xs.data(), sums.data(), done, count);
+      }
+#endif
+#ifdef NOISE_SSE2
+      if (kernel == NoiseKernel::sse2 || kernel == NoiseKernel::avx2) {
+         done = addOctaveSse2(row, xs.data(), sums.data(), done, count);
+      }
+#endif
+      addOctaveScalar(row, xs.data(), sums.data(), done, count);
+
+      for (double &value: xs) {
+         value *= 2;
+      }
+      py *= 2;
+      row.amplitude *= 0.5;
+   }
+
+   for (int i = 0; i < count; ++i) {
+      out[i] = float(sums[i]);
+   }
+}
+
+void octave2DBlock(const siv::PerlinNoise &noise, int x, int y, int width, int height, float scale, int octaves, float *out, NoiseKernel kernel) {
+   for (int row = 0; row < height; ++row) {
+      octave2DRow(noise, x, y + row, width, scale, octaves, out + row * width, kernel);
+   }
+}
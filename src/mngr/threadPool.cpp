@@ -0,0 +1,91 @@
+#include "mngr/threadPool.hpp"
+#include <algorithm>
+
+// Constructors
+
+ThreadPool::ThreadPool(int workerCount) {
+   for (int i = 0; i < workerCount; ++i) {
+      workers.emplace_back(&ThreadPool::workerLoop, this);
+   }
+}
+
+ThreadPool::~ThreadPool() {
+   {
+      std::lock_guard<std::mutex> lock (mutex);
+      stopping = true;
+   }
+   wakeCondition.notify_all();
+
+   for (std::thread &worker: workers) {
+      worker.join();
+   }
+}
+
+// Run functions
+
+void ThreadPool::run(int count, const std::function<void(int)> &function) {
+   std::unique_lock<std::mutex> runLock (runMutex, std::try_to_lock);
+   if (workers.empty() || count <= 1 || !runLock.owns_lock()) {
+      for (int i = 0; i < count; ++i) {
+         function(i);
+      }
+      return;
+   }
+
+   Batch current;
+   current.function = &function;
+   current.count = count;
+   {
+      std::lock_guard<std::mutex> lock (mutex);
+      batch = &current;
+      generation += 1;
+   }
+   wakeCondition.notify_all();
+   work(current);
+
+   // the batch lives on this stack, so wait until every worker has let go of it
+   std::unique_lock<std::mutex> lock (mutex);
+   doneCondition.wait(lock, [&]() { return current.done == count && current.active == 0; });
+   batch = nullptr;
+}
+
+void ThreadPool::workerLoop() {
+   unsigned long long seen = 0;
+   std::unique_lock<std::mutex> lock (mutex);
+
+   while (true) {
+      wakeCondition.wait(lock, [&]() { return stopping || (batch && generation != seen); });
+      if (stopping) {
+         return;
+      }
+      seen = generation;
+      Batch *current = batch;
+      current->active += 1;
+
+      lock.unlock();
+      work(*current);
+      lock.lock();
+
+      current->active -= 1;
+      doneCondition.notify_all();
+   }
+}
+
+void ThreadPool::work(Batch &batch) {
+   for (int i = batch.next++; i < batch.count; i = batch.next++) {
+      (*batch.function)(i);
+      batch.done += 1;
+   }
+}
+
+// Getter functions
+
+int ThreadPool::getThreadCount() const {
+   return workers.size() + 1;
+}
+
+ThreadPool &getThreadPool() {
+   // the calling thread takes part in every batch, so leave one hardware thread for it
+   static ThreadPool pool (std::max<int>(1, std::thread::hardware_concurrency()) - 1);
+   return pool;
+}
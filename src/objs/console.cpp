@@ -1,9 +1,10 @@
 #include "game/gameState.hpp"
+#include "mngr/assetHandles.hpp"
+#include "mngr/data.hpp"
 #include "objs/console.hpp"
 #include "objs/inventory.hpp"
 #include "objs/parallax.hpp"
 #include "objs/player.hpp"
-#include "SRU/assets.hpp"
 #include "SRU/file.hpp"
 #include "SRU/render.hpp"
 #include "SRU/text.hpp"
@@ -68,6 +69,7 @@ bool c_help(Console &console, std::vector<std::string> &args, GameState&) {
    console.output("give [NAME] [COUNT] - give specified item to the player.");
    console.output("set [VAR] [VALUE] - set VAR to VALUE.");
    console.output("list - list all variables.");
+   console.output("reload [all] - reload the config files that changed, or all of them.");
    console.output("cinv - clear the inventory.");
    console.output("tp [X] [Y] - teleport player to the given coordinates.");
    console.output("spawnpoint [X] [Y] - set player spawn point to the given coordinates.");
@@ -283,6 +285,11 @@ bool c_place(Console &console, std::vector<std::string> &args, GameState &state)
       return false;
    }
 
+   if (!state.map.isLoaded(x, y)) {
+      console.output("place: that part of the world is still loading.", RED);
+      return false;
+   }
+
    state.map.setBlock(x, y, id);
    console.output(TextFormat("place: set block at coordinates (X %d; Y %d) to '%s'.", x, y, getBlockNameFromId(id).c_str()));
    return true;
@@ -329,11 +336,12 @@ bool c_fill(Console &console, std::vector<std::string> &args, GameState &state)
    if (sy > dy) std::swap(sy, dy);
    if (sx > dx) std::swap(sx, dx);
 
-   for (int y = sy; y < dy; ++y) {
-      for (int x = sx; x < dx; ++x) {
-         state.map.setBlock(x, y, id);
-      }
+   if (!state.map.isAreaLoaded(sx, sy, dx - sx + 1, dy - sy + 1)) {
+      console.output("fill: that part of the world is still loading.", RED);
+      return false;
    }
+
+   state.map.setBlockRect(sx, sy, dx - sx, dy - sy, id);
    console.output(TextFormat("fill: filled all blocks from coordinates (X %d; Y %d) to (X %d; Y %d) as %s.", sx, sy, dx, dy, getBlockNameFromId(id).c_str()));
    return true;
 }
@@ -374,6 +382,11 @@ bool c_placew(Console &console, std::vector<std::string> &args, GameState &state
       return false;
    }
 
+   if (!state.map.isLoaded(x, y)) {
+      console.output("placew: that part of the world is still loading.", RED);
+      return false;
+   }
+
    state.map.setWall(x, y, id);
    console.output(TextFormat("placew: set wall at coordinates (X %d; Y %d) to '%s'.", x, y, getBlockNameFromId(id).c_str()));
    return true;
@@ -420,11 +433,12 @@ bool c_fillw(Console &console, std::vector<std::string> &args, GameState &state)
    if (sy > dy) std::swap(sy, dy);
    if (sx > dx) std::swap(sx, dx);
 
-   for (int y = sy; y < dy; ++y) {
-      for (int x = sx; x < dx; ++x) {
-         state.map.setWall(x, y, id);
-      }
+   if (!state.map.isAreaLoaded(sx, sy, dx - sx + 1, dy - sy + 1)) {
+      console.output("fillw: that part of the world is still loading.", RED);
+      return false;
    }
+
+   state.map.setWallRect(sx, sy, dx - sx, dy - sy, id);
    console.output(TextFormat("fillw: filled all walls from coordinates (X %d; Y %d) to (X %d; Y %d) as %s.", sx, sy, dx, dy, getBlockNameFromId(id).c_str()));
    return true;
 }
@@ -465,6 +479,11 @@ bool c_placeq(Console &console, std::vector<std::string> &args, GameState &state
       return false;
    }
 
+   if (!state.map.isLoaded(x, y)) {
+      console.output("placeq: that part of the world is still loading.", RED);
+      return false;
+   }
+
    state.map.deleteBlock(x, y);
    state.map.setLiquid(x, y, id, id == 0 ? 0 : maxLiquidLayers);
 
@@ -513,12 +532,12 @@ bool c_fillq(Console &console, std::vector<std::string> &args, GameState &state)
    if (sy > dy) std::swap(sy, dy);
    if (sx > dx) std::swap(sx, dx);
 
-   for (int y = sy; y < dy; ++y) {
-      for (int x = sx; x < dx; ++x) {
-         state.map.deleteBlock(x, y);
-         state.map.setLiquid(x, y, id, id == 0 ? 0 : maxLiquidLayers);
-      }
+   if (!state.map.isAreaLoaded(sx, sy, dx - sx + 1, dy - sy + 1)) {
+      console.output("fillq: that part of the world is still loading.", RED);
+      return false;
    }
+
+   state.map.setLiquidRect(sx, sy, dx - sx, dy - sy, id, id == 0 ? 0 : maxLiquidLayers);
    console.output(TextFormat("fillq: filled all liquids from coordinates (X %d; Y %d) to (X %d; Y %d) as %s.", sx, sy, dx, dy, getLiquidNameFromId(id).c_str()));
    return true;
 }
@@ -559,6 +578,11 @@ bool c_placef(Console &console, std::vector<std::string> &args, GameState &state
       return false;
    }
 
+   if (!state.map.isLoaded(x, y)) {
+      console.output("placef: that part of the world is still loading.", RED);
+      return false;
+   }
+
    generateFurniture(x, y, state.map, id, state.player.flipX);
    console.output(TextFormat("placef: attempted to place furniture '%s' at coordinates (X %d; Y %d).", getFurnitureNameFromId(id).c_str(), x, y));
    return true;
@@ -669,6 +693,26 @@ bool c_list(Console &console, std::vector<std::string> &args, GameState &state)
    return true;
 }
 
+bool c_reload(Console &console, std::vector<std::string> &args, GameState &state) {
+   if (args.size() > 2 || (args.size() == 2 && args[1] != "all")) {
+      console.output("reload: expected no arguments or 'all'.", RED);
+      return false;
+   }
+
+   ConfigFile files = (args.size() == 2 ? ConfigFile::all : getChangedConfigFiles());
+   if (files == ConfigFile::none) {
+      console.output("reload: no config file changed since it was last read.");
+      return true;
+   }
+
+   if (!state.reloadConfigs(files)) {
+      console.output("reload: the world is still loading, try again once it's done.", RED);
+      return false;
+   }
+   console.output("reload: reloaded the config files, see the log for details.");
+   return true;
+}
+
 // command map
 
 using Command = bool(*)(Console&, std::vector<std::string>&, GameState&);
@@ -677,6 +721,7 @@ static inline const std::unordered_map<std::string, Command> commands {
    {"cinv", c_cinv}, {"exit", c_exit}, {"hp", c_hp}, {"maxhp", c_maxhp}, {"kill", c_kill}, {"time", c_time}, {"hist", c_hist},
    {"chist", c_chist}, {"place", c_place}, {"fill", c_fill}, {"placew", c_placew}, {"fillw", c_fillw}, {"placeq", c_placeq},
    {"fillq", c_fillq}, {"placef", c_placef}, {"give", c_give}, {"set", c_set}, {"list", c_list},
+   {"reload", c_reload},
 };
 
 // init
@@ -685,7 +730,7 @@ void Console::init(GameState &state) {
    input.wrapinput = false;
    input.cursor = true;
    input.textOrigin = CENTER_RIGHT;
-   input.init(getFont("andy"), {0}, TOP_LEFT, 512, "'help' for a list of commands.");
+   input.init(*getAssetHandles().font, {0}, TOP_LEFT, 512, "'help' for a list of commands.");
    updateResponsiveness();
 
    // player
@@ -763,10 +808,25 @@ void Console::init(GameState &state) {
    vars["map.name"] = createVariable(&state.worldName);
 
    // physics
-   vars["physics.counter"] = createVariable(&state.physicsCounter);
-   vars["physics.ticks"] = createVariable(&state.physicsTicks);
-   vars["physics.grassGrowSpeed.min"] = createVariable(&state.grassGrowSpeedMin);
-   vars["physics.grassGrowSpeed.max"] = createVariable(&state.grassGrowSpeedMax);
+   vars["physics.counter"] = createVariable(&state.physics.physicsCounter);
+   vars["physics.ticks"] = createVariable(&state.physics.physicsTicks);
+   vars["physics.cellsUpdated"] = createVariable(&state.physics.cellsUpdated);
+   vars["physics.parallel"] = createVariable(&state.physics.parallelPhysics);
+   vars["physics.far"] = createVariable(&state.physics.farPhysics);
+   vars["physics.far.rate"] = createVariable(&state.physics.farPhysicsRate);
+   vars["physics.far.cells"] = createVariable(&state.physics.farPhysicsCells);
+   vars["physics.far.cellsUpdated"] = createVariable(&state.physics.farCellsUpdated);
+   vars["physics.grassGrowSpeed.min"] = createVariable(&state.physics.grassGrowSpeedMin);
+   vars["physics.grassGrowSpeed.max"] = createVariable(&state.physics.grassGrowSpeedMax);
+
+   // autosave
+   vars["autosave.interval"] = createVariable(&state.autosave.interval);
+   vars["autosave.snapshotMs"] = createVariable(&state.autosave.snapshotMs);
+   vars["autosave.saveMs"] = createVariable(&state.autosave.saveMs);
+   vars["autosave.chunksCopied"] = createVariable(&state.autosave.chunksCopied);
+
+   // assets
+   vars["assets.lookups"] = createVariable(&getAssetLookupCounter().lastFrame); // by name during the last frame
 
    // camera
    vars["camera.offset.x"] = createVariable(&state.camera.offset.x);
@@ -786,7 +846,7 @@ void Console::init(GameState &state) {
 
 void Console::output(const std::string &string, Color color) {
    size_t last = text.size();
-   divideTextInPlace(text, string, getFont("andy"), input.rect.width - mapRatioToX(0.01f, WINDOW_AREA, CUBIC_RATIO), getFontSizeScaled(consoleFontSize));
+   divideTextInPlace(text, string, *getAssetHandles().font, input.rect.width - mapRatioToX(0.01f, WINDOW_AREA, CUBIC_RATIO), getFontSizeScaled(consoleFontSize));
 
    for (size_t i = last; i < text.size(); ++i) {
       textColors.push_back(color);
@@ -840,7 +900,7 @@ void Console::render() {
    Rectangle area = mapRatioToArea(R4(0.0f, 1.0f, 0.92f, 0.3f), BOTTOM_LEFT, WINDOW_AREA, CUBIC_RATIO);
    Rectangle outputArea = mapRatioToArea(R4(0.0f, 1.0f, 0.92f, 0.3f - 0.05f), BOTTOM_LEFT, WINDOW_AREA, CUBIC_RATIO);
 
-   Font &font = getFont("andy");
+   Font &font = *getAssetHandles().font;
    float constX = area.x + mapRatioToX(0.005f, WINDOW_AREA, CUBIC_RATIO);
    float constY = area.y + mapRatioToY(0.005f, WINDOW_AREA, CUBIC_RATIO);
    float paddingY = mapRatioToHeight((1.0f - 0.005f) / maxLines, outputArea, CUBIC_RATIO);
@@ -1,4 +1,5 @@
 #include "objs/furniture.hpp"
+#include "mngr/random.hpp"
 #include "SRU/random.hpp"
 #include "objs/map.hpp"
 #include "objs/player.hpp"
@@ -114,6 +115,12 @@ void pushFurniture(const std::string &name) {
    furnitureCount += 1;
 }
 
+// setFurniture only ever adds to the soil lookups, so a reload empties them first
+void clearFurnitureSoils() {
+   saplingSoils.clear();
+   treeSoils.clear();
+}
+
 void setFurniture(const std::string &name, FurnitureData data, const std::vector<blockid_t> &saplingSoils, const std::vector<blockid_t> &treeSoils) {
    furnitureid_t id = furnitureIds.at(name);
    furnitureData[id] = data;
@@ -141,12 +148,7 @@ bool Furniture::isSolidUnderneath(const Map &map, FurnitureData &data, bool prev
    if (previewing) {
       return true;
    }
-   for (int dx = x; dx < x + width; ++dx) {
-      if (!map.is(dx, y + height, BlockType::solid)) {
-         return false;
-      }
-   }
-   return true;
+   return map.allInSpan(Plane::solid, y + height, x, x + width - 1);
 }
 
 bool Furniture::isSuitableForPlant(const Map &map, FurnitureData &data, bool previewing) const {
@@ -180,9 +182,10 @@ bool Furniture::setSimpleFurniture(const Map &map, FurnitureData &data, bool pla
    return true;
 }
 
-bool Furniture::setPlant(const Map &map, FurnitureData &data, bool previewing) {
+bool Furniture::setPlant(const Map &map, FurnitureData &data, bool previewing, RandomStream &random) {
    int textureWidth = data.textureSize * width;
-   int offset = randomInt(0, data.texture.width / textureWidth - 1) * textureWidth;
+   int variants = std::max(1, data.texture.width / textureWidth); // headless data has no textures to pick from
+   int offset = random.randomInt(0, variants - 1) * textureWidth;
 
    for (int dy = 0; dy < height; ++dy) {
       for (int dx = 0; dx < width; ++dx) {
@@ -298,13 +301,17 @@ void Furniture::render(const Rectangle &cameraBounds) const {
 
 // Furniture generation functions
 
-Furniture getFurniture(int x, int y, const Map &map, furnitureid_t id, bool playerFacingLeft, bool previewing) {
+Furniture getFurniture(int x, int y, const Map &map, furnitureid_t id, bool playerFacingLeft, bool previewing, RandomStream *stream) {
    FurnitureData data = furnitureData[id];
 
+   // the world generator passes its own stream so the same seed grows the same trees, everything else gets a fresh one
+   RandomStream fallback (randomInt(0, std::numeric_limits<int>::max()), 0);
+   RandomStream &random = (stream ? *stream : fallback);
+
    switch (data.type) {
    case FurnitureType::tree: {
       // trees are not placed by top-left but from center-bottom.
-      int treeHeight = randomInt(data.treeSizeMin, data.treeSizeMax);
+      int treeHeight = random.randomInt(data.treeSizeMin, data.treeSizeMax);
       bool isPalm = (data.treeRootChance == 0 && data.treeBranchChance == 0 && !data.treeIsCactus);
       int topHeight = (data.treeIsCactus ? 0 : (isPalm ? 3 : 2));
       int middle = treeWidth / 2;
@@ -338,7 +345,7 @@ Furniture getFurniture(int x, int y, const Map &map, furnitureid_t id, bool play
 
       // place the tree top
       if (!data.treeIsCactus) {
-         int topOffset = chance(50) * treeWidth * data.textureSize;
+         int topOffset = random.chance(50) * treeWidth * data.textureSize;
          for (int dy = 0; dy < topHeight; ++dy) {
             for (int dx = 0; dx < treeWidth; ++dx) {
                int i = dy * treeWidth + dx;
@@ -352,8 +359,8 @@ Furniture getFurniture(int x, int y, const Map &map, furnitureid_t id, bool play
          for (int dy = 0; dy < treeHeight; ++dy) {
             int middleI = dy * treeWidth + middle;
             int worldY = y - treeHeight + 1 + dy;
-            tree.pieces[middleI-1].nil = (dy + 1 == treeHeight || dy == 0 || !map.isNotSolid(x - 1, worldY) || chance(100 - data.treeBranchChance));
-            tree.pieces[middleI+1].nil = (dy + 1 == treeHeight || dy == 0 || !map.isNotSolid(x + 1, worldY) || chance(100 - data.treeBranchChance));
+            tree.pieces[middleI-1].nil = (dy + 1 == treeHeight || dy == 0 || !map.isNotSolid(x - 1, worldY) || random.chance(100 - data.treeBranchChance));
+            tree.pieces[middleI+1].nil = (dy + 1 == treeHeight || dy == 0 || !map.isNotSolid(x + 1, worldY) || random.chance(100 - data.treeBranchChance));
          }
       }
 
@@ -365,7 +372,7 @@ Furniture getFurniture(int x, int y, const Map &map, furnitureid_t id, bool play
 
          if (isPalm) {
             int topOffset = (dy + 1 == trunkHeight ? 4 : 3);
-            tree.pieces[middleI].tx = randomInt(0, 2) * data.textureSize;
+            tree.pieces[middleI].tx = random.randomInt(0, 2) * data.textureSize;
             tree.pieces[middleI].ty = topOffset * data.textureSize;
 
             tree.pieces[middleI-1].nil = true;
@@ -379,7 +386,7 @@ Furniture getFurniture(int x, int y, const Map &map, furnitureid_t id, bool play
             // a lot of clever bool logic incoming. it just works and saves long if chains. I don't recommend tinkering too much
             // with cactus or tree sprite layouts and just going with the flow here. another yucky trick is not checking nil
             // on stubs and applying tx and ty anyway since nil pieces don't check them.
-            int topOffset = anyStub * (rightStub + leftStub * 2) + !anyStub * ((dy + 1 == trunkHeight) * 3 + (dy == 0) * chance(data.treeCactusFlowerChance));
+            int topOffset = anyStub * (rightStub + leftStub * 2) + !anyStub * ((dy + 1 == trunkHeight) * 3 + (dy == 0) * random.chance(data.treeCactusFlowerChance));
             int leftOffset = !anyStub * (dy == 0 || dy + 1 == trunkHeight);
             tree.pieces[middleI].tx = leftOffset * data.textureSize;
             tree.pieces[middleI].ty = topOffset * data.textureSize;
@@ -398,8 +405,8 @@ Furniture getFurniture(int x, int y, const Map &map, furnitureid_t id, bool play
             // some more clever bool logic here.
             bool isRoot = dy + 1 == trunkHeight;
             int percent = (isRoot ? data.treeRootChance : data.treeBranchChance);
-            bool leftFree = map.isNotSolid(x - 1, worldY) && chance(percent) && (!isRoot || (isRoot && map.isSoil(x - 1, worldY + 1)));
-            bool rightFree = map.isNotSolid(x + 1, worldY) && chance(percent) && (!isRoot || (isRoot && map.isSoil(x + 1, worldY + 1)));
+            bool leftFree = map.isNotSolid(x - 1, worldY) && random.chance(percent) && (!isRoot || (isRoot && map.isSoil(x - 1, worldY + 1)));
+            bool rightFree = map.isNotSolid(x + 1, worldY) && random.chance(percent) && (!isRoot || (isRoot && map.isSoil(x + 1, worldY + 1)));
 
             int topOffsetMiddle = (isRoot ? 4 : 3);
             int leftOffsetMiddle = (rightFree) * 3 + (leftFree) + (rightFree && leftFree) + (!leftFree && !rightFree) * 2;
@@ -407,8 +414,8 @@ Furniture getFurniture(int x, int y, const Map &map, furnitureid_t id, bool play
             tree.pieces[middleI].ty = topOffsetMiddle * data.textureSize;
 
             int topOffsetBranches = (isRoot ? 4 : 2) * data.textureSize;
-            int leftOffsetLeftBranch = (!isRoot) * randomInt(0, 2);
-            int leftOffsetRightBranch = (isRoot ? 4 : randomInt(3, 5));
+            int leftOffsetLeftBranch = (!isRoot) * random.randomInt(0, 2);
+            int leftOffsetRightBranch = (isRoot ? 4 : random.randomInt(3, 5));
             tree.pieces[middleI-1].tx = leftOffsetLeftBranch * data.textureSize;
             tree.pieces[middleI-1].ty = topOffsetBranches;
             tree.pieces[middleI-1].nil = !leftFree;
@@ -423,8 +430,8 @@ Furniture getFurniture(int x, int y, const Map &map, furnitureid_t id, bool play
    case FurnitureType::sapling: {
       Furniture sapling;
       sapling.init(id, x, y, data.furnitureSize.x, data.furnitureSize.y);
-      if (sapling.isSuitableForPlant(map, data, previewing) && sapling.setPlant(map, data, previewing)) {
-         sapling.fvalue1 = randomFloat(data.saplingGrowSpeedMin, data.saplingGrowSpeedMax);
+      if (sapling.isSuitableForPlant(map, data, previewing) && sapling.setPlant(map, data, previewing, random)) {
+         sapling.fvalue1 = random.randomFloat(data.saplingGrowSpeedMin, data.saplingGrowSpeedMax);
          return sapling;
       }
    } break;
@@ -454,8 +461,8 @@ Furniture getFurniture(int x, int y, const Map &map, furnitureid_t id, bool play
    return {};
 }
 
-void generateFurniture(int x, int y, Map &map, furnitureid_t type, bool playerFacingleft) {
-   Furniture furniture = getFurniture(x, y, map, type, playerFacingleft);
+void generateFurniture(int x, int y, Map &map, furnitureid_t type, bool playerFacingleft, RandomStream *random) {
+   Furniture furniture = getFurniture(x, y, map, type, playerFacingleft, false, random);
    if (furniture.id != 0) {
       map.addFurniture(furniture);
    }
@@ -1,8 +1,12 @@
 #include "mngr/fileio.hpp"
+#include "mngr/noise.hpp"
+#include "mngr/random.hpp"
+#include "mngr/threadPool.hpp"
 #include "objs/generation.hpp"
-#include "SRU/audio.hpp"
-#include "SRU/random.hpp"
-#include <thread>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
 
 // Constants
 
@@ -14,6 +18,14 @@ constexpr int rockOffsetStart = 12;
 constexpr int rockOffsetMin   = 5;
 constexpr int rockOffsetMax   = 25;
 constexpr int maxWaterLength  = 60;
+constexpr int biomeBlendRadius = 6;
+
+// passes that write tiles run over strips of columns on the thread pool, see forEachStrip
+constexpr int generationStripWidth = 64;
+constexpr int generationPhases     = 3;
+
+// every pass draws from its own stream of the world seed. append new passes at the end, reordering changes every world
+enum class GenerationStream: uint64_t { noise, terrain, trees, terrainBlend };
 
 struct BiomeData {
    int hmin[5];
@@ -40,11 +52,11 @@ static inline const std::array<BiomeData, biomeCount> biomeData {{
 
 // Constructors
 
-MapGenerator::MapGenerator(const std::string &name, int sizeX, int sizeY, bool isFlat, std::mutex &infoTextMutex, std::string &infoText, float &progress)
-   : infoTextMutex(infoTextMutex), infoText(infoText), progress(progress), name(name), isFlat(isFlat) {
+MapGenerator::MapGenerator(const std::string &name, int sizeX, int sizeY, bool isFlat, uint64_t seed, std::mutex &infoTextMutex, std::string &infoText, float &progress)
+   : infoTextMutex(infoTextMutex), infoText(infoText), progress(progress), name(name), isFlat(isFlat), seed(seed) {
    map.sizeX = sizeX;
    map.sizeY = sizeY;
-   map.initThreadSafe();
+   map.seed = seed;
    setInfo("Initializing...", 0.0f);
 }
 
@@ -52,63 +64,91 @@ MapGenerator::MapGenerator(const std::string &name, int sizeX, int sizeY, bool i
 
 void MapGenerator::generate() {
    map.initContainers(); // Do expensive initialization in a thread
-   rockStartHeights.resize(map.sizeX);
+   passTimes.clear();
 
    setInfo("Seeding Noise...", 0.0f);
    if (!isFlat) {
-      biomeTemperatureNoise.reseed(rand());
-      biomeMoistureNoise.reseed(rand());
-      heightNoise.reseed(rand());
-      sandDebriNoise.reseed(rand());
-      dirtDebriNoise.reseed(rand());
-      oreNoise1.reseed(rand());
-      oreNoise2.reseed(rand());
+      RandomStream random (seed, (uint64_t)GenerationStream::noise);
+      biomeTemperatureNoise.reseed(siv::PerlinNoise::seed_type(random.next()));
+      biomeMoistureNoise.reseed(siv::PerlinNoise::seed_type(random.next()));
+      heightNoise.reseed(siv::PerlinNoise::seed_type(random.next()));
+      sandDebriNoise.reseed(siv::PerlinNoise::seed_type(random.next()));
+      dirtDebriNoise.reseed(siv::PerlinNoise::seed_type(random.next()));
+      oreNoise1.reseed(siv::PerlinNoise::seed_type(random.next()));
+      oreNoise2.reseed(siv::PerlinNoise::seed_type(random.next()));
    }
 
    if (isFlat) {
-      generateFlatWorld();
+      runPass("Generating Flat Terrain...", 0.1f, &MapGenerator::generateFlatWorld);
    } else {
-      generateTerrain();
-      generateDebri();
-      generateWater();
-      generateTrees();
+      runPass("Computing Biomes...", 0.05f, &MapGenerator::generateBiomes);
+      runPass("Shaping Terrain...", 0.1f, &MapGenerator::generateHeights);
+      runPass("Generating Terrain...", 0.2f, &MapGenerator::generateTerrain);
+      runPass("Generating Debri and Ores...", 0.5f, &MapGenerator::generateDebri);
+      runPass("Filling Water...", 0.75f, &MapGenerator::generateWater);
+      runPass("Growing Trees...", 0.85f, &MapGenerator::generateTrees);
    }
 
    const Vector2 spawnLocation = findPlayerSpawnLocation();
 
    setInfo("Saving to File...", 0.95f);
-   saveWorldData(name, spawnLocation, spawnLocation, false, 100, 100, 100, 50.f, map, nullptr, nullptr, nullptr);
+   saveWorldData(name, spawnLocation, spawnLocation, false, 100, 100, 100, 50.f, 0.0f, 0, map, nullptr, nullptr, nullptr);
 
    setInfo("Generating Completed!", 1.0f);
-   playSound("success");
-   std::this_thread::sleep_for(std::chrono::milliseconds(500));
    isCompleted = true;
 }
 
-void MapGenerator::generateTerrain() {
-   setInfo("Generating Terrain...", 0.1f);
+void MapGenerator::generateBiomes() {
+   forEachStrip([&](int minX, int maxX) {
+      for (int x = minX; x <= maxX; ++x) {
+         map.biomes[x].biome = getNoiseBiome(x);
+      }
+   });
+
+   // blend in the closest other biome within the radius, half and half right at the border and fading out from there
+   forEachStrip([&](int minX, int maxX) {
+      for (int x = minX; x <= maxX; ++x) {
+         BiomeColumn &column = map.biomes[x];
+         for (int distance = 1; distance <= biomeBlendRadius; ++distance) {
+            int left = std::max(x - distance, 0);
+            int right = std::min(x + distance, map.sizeX - 1);
+            Biome other = (map.biomes[left].biome != column.biome ? map.biomes[left].biome : map.biomes[right].biome);
+
+            if (other != column.biome) {
+               column.blendBiome = other;
+               column.blend = 255 * (biomeBlendRadius + 1 - distance) / (2 * biomeBlendRadius);
+               break;
+            }
+         }
+      }
+   });
+}
+
+void MapGenerator::generateHeights() {
+   // The surface is a random walk, every column starts where the last one ended. this is the only part of the terrain
+   // that has to run in order, so it only decides the heights and leaves writing the tiles to the passes after it
+   RandomStream random (seed, (uint64_t)GenerationStream::terrain);
+   terrainHeights.resize(map.sizeX);
+   rockStartHeights.resize(map.sizeX);
 
-   Biome current = Biome::plains, last = Biome::plains;
    int y = startY * map.sizeY;
-   int rockOffset = rockOffsetStart, waterLength = 0;
+   int rockOffset = std::clamp(rockOffsetStart, rockOffsetMin, rockOffsetMax);
+   int waterLength = 0;
 
    for (int x = 0; x < map.sizeX; ++x) {
       float value = normalizedNoise2D(heightNoise, x, y, 0.01f);
-      last = current;
-      current = getBiome(x);
 
       // Get different height increase/decrease based on the noise and the biome,
       // normal 2D perlin noise is better for top-down generation.
 
-      const BiomeData &data = biomeData.at((int)current);
-      const BiomeData &lastData = biomeData.at((int)last);
+      const BiomeData &data = biomeData.at((int)map.biomes[x].biome);
 
       int height = std::floor(value * 5.f);
-      y += randomInt(data.hmin[height], data.hmax[height]);
+      y += random.randomInt(data.hmin[height], data.hmax[height]);
 
       // 2 is the middle point in our data
-      if ((height == 2 && chance(data.rng)) || height != 2) {
-         y += randomInt(-1, 1);
+      if ((height == 2 && random.chance(data.rng)) || height != 2) {
+         y += random.randomInt(-1, 1);
       }
 
       if (y > map.sizeY * seaLevel) {
@@ -122,53 +162,89 @@ void MapGenerator::generateTerrain() {
       }
 
       if (y > map.sizeY * data.lowestPoint || waterLength >= maxWaterLength) {
-         y += data.hmin[randomInt(0, 2)];
+         y += data.hmin[random.randomInt(0, 2)];
       }
 
       y = std::clamp(y, 0, map.sizeY - 1);
-      rockOffset = std::clamp(rockOffset, rockOffsetMin, rockOffsetMax);
+      terrainHeights[x] = y;
+      rockStartHeights[x] = std::min(y + rockOffset, map.sizeY);
+   }
+}
 
-      // Generate grass, dirt and stone
+void MapGenerator::generateTerrain() {
+   // where two biomes meet the blocks are mixed by the column's blend weight, decided per tile so every column can be
+   // filled on its own
+   uint64_t blendSalt = RandomStream(seed, (uint64_t)GenerationStream::terrainBlend).next();
+   blockid_t stoneid = getBlockIdFromName("stone");
+
+   std::array<blockid_t, biomeCount> topIds, bottomIds;
+   std::array<bool, biomeCount> bottomWalls;
+   for (int biome = 0; biome < biomeCount; ++biome) {
+      topIds[biome] = getBlockIdFromName(biomeData[biome].top);
+      bottomIds[biome] = getBlockIdFromName(biomeData[biome].bottom);
+      bottomWalls[biome] = (biomeData[biome].bottom != "sand" && biomeData[biome].bottom != "snow");
+   }
 
-      map.setBlock(x, y, (last != current && chance(50) ? lastData.top : data.top));
-      for (int yy = y + 1; yy < map.sizeY; ++yy) {
-         if (yy - y < rockOffset) {
-            const std::string &block = (last != current && chance(50) ? lastData.bottom : data.bottom);
-            map.setBlock(x, yy, block);
+   forEachStrip([&](int minX, int maxX) {
+      // below the deepest rock start of the strip it's stone all the way, so that part is written row by row instead
+      // of column by column
+      int stoneY = *std::max_element(&rockStartHeights[minX], &rockStartHeights[maxX] + 1);
+      map.setBlockRect(minX, stoneY, maxX - minX + 1, map.sizeY - stoneY, stoneid);
+      map.setWallRect(minX, stoneY, maxX - minX + 1, map.sizeY - stoneY, stoneid);
+
+      for (int x = minX; x <= maxX; ++x) {
+         const BiomeColumn &column = map.biomes[x];
+         int blendChance = column.blend * 100 / 255;
+         int y = terrainHeights[x];
+         auto getTileBiome = [&](int yy) {
+            return (int)(cellChance(x, yy, blendSalt, blendChance) ? column.blendBiome : column.biome);
+         };
+
+         // Generate grass, dirt and stone. the soil goes down in runs of the same block, away from biome borders
+         // that's the whole layer in one go
+
+         map.setBlock(x, y, topIds[getTileBiome(y)]);
+         for (int yy = y + 1; yy < rockStartHeights[x];) {
+            int biome = getTileBiome(yy);
+            int end = yy + 1;
+            while (end < rockStartHeights[x] && getTileBiome(end) == biome) {
+               end += 1;
+            }
 
-            if (block != "sand" && block != "snow") {
-               map.setWall(x, yy, block);
+            map.setBlockColumn(x, yy, end - yy, bottomIds[biome]);
+            if (bottomWalls[biome]) {
+               map.setWallColumn(x, yy, end - yy, bottomIds[biome]);
             }
-         } else {
-            rockStartHeights[x] = yy;
-            map.setColumnFromPoint(x, yy, "stone");
-            break;
+            yy = end;
          }
+
+         map.setBlockColumn(x, rockStartHeights[x], stoneY - rockStartHeights[x], stoneid);
+         map.setWallColumn(x, rockStartHeights[x], stoneY - rockStartHeights[x], stoneid);
       }
-   }
+   });
 }
 
 void MapGenerator::generateWater() {
-   setInfo("Filling Water...", 0.75f);
-
    int seaY = map.sizeY * seaLevel;
    blockid_t iceid = getBlockIdFromName("ice");
    liquidid_t waterid = getLiquidIdFromName("water");
 
-   for (int x = 0; x < map.sizeX; ++x) {
-      for (int y = seaY; y < map.sizeY && map.isEmpty(x, y); ++y) {
-         if (y == seaY && biomeData[(int)getBiome(x)].wamth == BiomeWarmth::cold) {
+   forEachStrip([&](int minX, int maxX) {
+      for (int x = minX; x <= maxX; ++x) {
+         // nothing but air above the surface at this point, water is the first liquid we place
+         int surfaceY = map.getSurfaceY(x);
+         int y = seaY;
+
+         if (y < surfaceY && biomeData[(int)map.biomes[x].biome].wamth == BiomeWarmth::cold) {
             map.setBlock(x, y, iceid);
-         } else {
-            map.setLiquid(x, y, waterid, maxLiquidLayers);
+            y += 1;
          }
+         map.setLiquidRect(x, y, 1, surfaceY - y, waterid, maxLiquidLayers);
       }
-   }
+   });
 }
 
 void MapGenerator::generateDebri() {
-   setInfo("Generating Debri and Ores...", 0.5f);
-
    blockid_t clayid = getBlockIdFromName("clay");
    blockid_t dirtid = getBlockIdFromName("dirt");
    blockid_t sandid = getBlockIdFromName("sand");
@@ -179,99 +255,118 @@ void MapGenerator::generateDebri() {
 
    int tier2OreY = tier2OreStartY * map.sizeY;
 
-   for (int x = 0; x < map.sizeX; ++x) {
-      for (int y = rockStartHeights[x]; y < map.sizeY; ++y) {
-         float value = dirtDebriNoise.octave2D(x * 0.05f, y * 0.05f, 3);
-
-         // Debris
-         if (value >= 0.6125f) {
-            map.setBlock(x, y, clayid);
-         } else if (value <= -0.6f) {
-            map.setBlock(x, y, dirtid);
-         } else if (sandDebriNoise.octave2D(x * 0.05f, y * 0.05f, 3) <= -0.7f) {
-            map.setBlock(x, y, sandid);
-
-         // Tier 1 ores (coal, iron)
-         } else {
-
-         float ovalue1 = oreNoise1.octave2D(x * 0.1f, y * 0.1f, 3);
-         if (ovalue1 >= 0.65f) {
-            map.setBlock(x, y, coalid);
-         } else if (ovalue1 <= -0.7f) {
-            map.setBlock(x, y, ironid);
-
-         // Tier 2 ores (gold, mythril)
-         } else if (y >= tier2OreY) {
-
-         float ovalue2 = oreNoise2.octave2D(x * 0.125f, y * 0.125f, 3);
-         if (ovalue2 >= 0.725f) {
-            map.setBlock(x, y, goldid);
-         } else if (ovalue2 <= -0.75f) {
-            map.setBlock(x, y, mythid);
+   // the noise is filled a strip row at a time, all four layers up front. that's more values than the checks below
+   // end up reading, but the batched rows are several times cheaper than the calls they replace. the row is then
+   // written with one mask, a strip is never wider than its bits
+   static_assert(generationStripWidth <= 64);
+   forEachStrip([&](int minX, int maxX) {
+      int width = maxX - minX + 1;
+      int minY = *std::min_element(rockStartHeights.begin() + minX, rockStartHeights.begin() + maxX + 1);
+      std::vector<float> dirtValues (width), sandValues (width), oreValues1 (width), oreValues2 (width);
+      std::vector<blockid_t> ids (width);
+
+      for (int y = minY; y < map.sizeY; ++y) {
+         octave2DRow(dirtDebriNoise, minX, y, width, 0.05f, 3, dirtValues.data());
+         octave2DRow(sandDebriNoise, minX, y, width, 0.05f, 3, sandValues.data());
+         octave2DRow(oreNoise1, minX, y, width, 0.1f, 3, oreValues1.data());
+         if (y >= tier2OreY) {
+            octave2DRow(oreNoise2, minX, y, width, 0.125f, 3, oreValues2.data());
          }
 
+         uint64_t mask = 0;
+         for (int i = 0; i < width; ++i) {
+            if (y < rockStartHeights[minX + i]) {
+               continue;
+            }
+            float value = dirtValues[i];
+            blockid_t &id = ids[i];
+            id = 0;
+
+            // Debris
+            if (value >= 0.6125f) {
+               id = clayid;
+            } else if (value <= -0.6f) {
+               id = dirtid;
+            } else if (sandValues[i] <= -0.7f) {
+               id = sandid;
+
+            // Tier 1 ores (coal, iron)
+            } else {
+
+            float ovalue1 = oreValues1[i];
+            if (ovalue1 >= 0.65f) {
+               id = coalid;
+            } else if (ovalue1 <= -0.7f) {
+               id = ironid;
+
+            // Tier 2 ores (gold, mythril)
+            } else if (y >= tier2OreY) {
+
+            float ovalue2 = oreValues2[i];
+            if (ovalue2 >= 0.725f) {
+               id = goldid;
+            } else if (ovalue2 <= -0.75f) {
+               id = mythid;
+            }
+
+            }
+            }
+            mask |= uint64_t(id != 0) << i;
          }
-         }
+         map.setBlockMask(minX, y, mask, ids.data());
       }
-   }
-   rockStartHeights.clear();
+   });
 }
 
 void MapGenerator::generateTrees() {
-   setInfo("Growing Trees...", 0.85f);
+   RandomStream random (seed, (uint64_t)GenerationStream::trees);
 
-   float y = startY * map.sizeY + 1;
    int counter = 0, counterThreshold = 0;
    
    for (int x = 0; x < map.sizeX; ++x) {
-      while (y < map.sizeY - 1 && map.isEmpty(x, y + 1)) { y++; }
-      while (y > 0 && !map.isEmpty(x, y)) { y--; }
+      int y = std::clamp(map.getSurfaceY(x), 1, map.sizeY - 1) - 1;
 
-      if (counter < counterThreshold || !chance(biomeData[(int)getBiome(x)].treeRate)) {
+      if (counter < counterThreshold || !random.chance(biomeData[(int)map.biomes[x].biome].treeRate)) {
          counter++;
          continue;
       }
-      blockid_t soilId = map.getBlock(x, y + 1).id;
-      bool sapling = (isSaplingSoil(soilId) && chance(5)) || (isSaplingSoil(soilId) && !isTreeSoil(soilId));
+      // trees don't grow underwater
+      blockid_t soilId = (map.isLiquid(x, y) ? 0 : map.getBlock(x, y + 1).id);
+      bool sapling = (isSaplingSoil(soilId) && random.chance(5)) || (isSaplingSoil(soilId) && !isTreeSoil(soilId));
    
       if (sapling || isTreeSoil(soilId)) {
-         furnitureid_t id = randomElement(sapling ? getSaplingsFromSoil(soilId) : getTreesFromSoil(soilId));
-         generateFurniture(x, y - sapling * (getFurnitureData(id).furnitureSize.y - 1), map, id, false);
+         furnitureid_t id = random.randomElement(sapling ? getSaplingsFromSoil(soilId) : getTreesFromSoil(soilId));
+         generateFurniture(x, y - sapling * (getFurnitureData(id).furnitureSize.y - 1), map, id, false, &random);
       }
       counter = 0;
-      counterThreshold = randomInt(1, 4);
+      counterThreshold = random.randomInt(1, 4);
    }
 }
 
 // Generation functions for flat worlds
 
 void MapGenerator::generateFlatWorld() {
-   setInfo("Generating Flat Terrain...", 0.1f);
    int startingPointY = startY * map.sizeY;
-   int rockStart = rockOffsetStart + startingPointY;
+   int rockStart = std::min(rockOffsetStart + startingPointY, map.sizeY);
+   blockid_t grassid = getBlockIdFromName("grass");
+   blockid_t dirtid = getBlockIdFromName("dirt");
+   blockid_t stoneid = getBlockIdFromName("stone");
 
-   map.setRow(startingPointY, "grass");
-   for (int y = startingPointY + 1; y < map.sizeY; ++y) {
-      if (y < rockStart) {
-         map.setRow(y, "dirt");
-         map.setWallRow(y, "dirt");
-      } else {
-         map.setRow(y, "stone");
-         map.setWallRow(y, "stone");
-      }
-   }
+   map.setBlockRect(0, startingPointY, map.sizeX, 1, grassid);
+   map.setBlockRect(0, startingPointY + 1, map.sizeX, rockStart - startingPointY - 1, dirtid);
+   map.setWallRect(0, startingPointY + 1, map.sizeX, rockStart - startingPointY - 1, dirtid);
+   map.setBlockRect(0, rockStart, map.sizeX, map.sizeY - rockStart, stoneid);
+   map.setWallRect(0, rockStart, map.sizeX, map.sizeY - rockStart, stoneid);
 }
 
 // Find a perfect spawn location for the player
 
 Vector2 MapGenerator::findPlayerSpawnLocation() {
    setInfo("Finding Player Spawn Location...", 0.9f);
-   float y = startY * map.sizeY + 1;
    int offset = 0;
 
    for (int x = map.sizeX / 2; x < map.sizeX && x >= 0; x = map.sizeX / 2 + offset) {
-      while (y < map.sizeY - 1 && map.isEmpty(x, y + 1)) { y++; }
-      while (y > 0 && !map.isEmpty(x, y)) { y--; }
+      float y = std::clamp(map.getSurfaceY(x), 1, map.sizeY - 1) - 1;
 
       bool valid = true;
       for (int yy = 0; yy < 3; ++yy) {
@@ -298,7 +393,7 @@ Vector2 MapGenerator::findPlayerSpawnLocation() {
 
 // Getter functions
 
-MapGenerator::Biome MapGenerator::getBiome(int x) {
+MapGenerator::Biome MapGenerator::getNoiseBiome(int x) {
    float temperature = normalizedNoise1D(biomeTemperatureNoise, x, 0.004f);
    float moisture = normalizedNoise1D(biomeMoistureNoise, x, 0.004f);
 
@@ -336,8 +431,63 @@ float MapGenerator::normalizedNoise2D(siv::PerlinNoise &noise, int x, int y, flo
    return (noise.octave2D(x * amplitude, y * amplitude, 4) + 1.f) / 2.f;
 }
 
+// Seed functions
+
+uint64_t getRandomSeed() {
+   std::random_device device;
+   uint64_t time = std::chrono::steady_clock::now().time_since_epoch().count();
+   return mixBits((uint64_t(device()) << 32 | device()) ^ time);
+}
+
+// plain numbers are used as they are, anything else is hashed so players can type words. empty means a random seed
+uint64_t getSeedFromString(const std::string &text) {
+   if (text.empty()) {
+      return getRandomSeed();
+   }
+
+   if (text.size() <= 19 && std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+      return std::stoull(text);
+   }
+
+   uint64_t hash = 0xcbf29ce484222325ull; // FNV-1a
+   for (unsigned char c: text) {
+      hash = (hash ^ c) * 0x100000001b3ull;
+   }
+   return hash;
+}
+
 // Other functions
 
+// runs one pass and leaves its time in the info text until the next pass starts, so slow passes show up on the loading
+// screen as well as in the log
+void MapGenerator::runPass(const std::string &text, float progress, void (MapGenerator::*pass)()) {
+   setInfo(text, progress);
+   auto begin = std::chrono::steady_clock::now();
+   (this->*pass)();
+   double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+   char timeText[32];
+   std::snprintf(timeText, sizeof(timeText), " %.1fms", ms);
+   passTimes.push_back({text, ms});
+   setInfo(text + timeText, progress);
+   printf("MapGenerator: %s%s\n", text.c_str(), timeText);
+}
+
+// Strips are 64 columns wide, aligned to the occupancy plane words and chunks. writing a tile wakes its neighbours, which
+// can reach one column into the strips next to it, so strips that run at the same time are generationPhases apart.
+// every column is written by exactly one strip, so the result doesn't depend on the number of threads
+void MapGenerator::forEachStrip(const std::function<void(int minX, int maxX)> &function) {
+   int strips = (map.sizeX + generationStripWidth - 1) / generationStripWidth;
+
+   for (int phase = 0; phase < generationPhases; ++phase) {
+      int count = (strips - phase + generationPhases - 1) / generationPhases;
+      getThreadPool().run(count, [&](int i) {
+         int minX = (phase + i * generationPhases) * generationStripWidth;
+         function(minX, std::min(minX + generationStripWidth, map.sizeX) - 1);
+      });
+   }
+}
+
 void MapGenerator::setInfo(const std::string &text, float progress) {
    std::lock_guard<std::mutex> lock(infoTextMutex);
    infoText = text;
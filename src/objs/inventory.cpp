@@ -1,9 +1,8 @@
 #include "SRU/util.hpp"
+#include "mngr/assetHandles.hpp"
 #include "mngr/input.hpp"
 #include "objs/inventory.hpp"
 #include "objs/map.hpp"
-#include "SRU/audio.hpp"
-#include "SRU/assets.hpp"
 #include "SRU/render.hpp"
 #include <raymath.h>
 #include <algorithm>
@@ -38,7 +37,7 @@ void Inventory::update(bool canSwitchOnScroll) {
    }
 
    if (selected != lastSelected) {
-      playSound("hover");
+      playSound(getAssetHandles().hover);
    }
 
    // Handle item operations
@@ -64,30 +63,30 @@ void Inventory::update(bool canSwitchOnScroll) {
 
       // select frames while inventory is closed
       if (mousePressed && i < inventoryWidth) {
-         if (!open) playSound("click");
+         if (!open) playSound(getAssetHandles().click);
          selected = i;
          shouldResetClick = false;
       }
 
       // favoriting
       if (mousePressed && (IsKeyDown(KEY_LEFT_ALT) || IsKeyDown(KEY_RIGHT_ALT)) && isValid && !isTrash) {
-         playSound("click");
+         playSound(getAssetHandles().click);
          item.favorite = !item.favorite;
       }
       // quick-trashing
       else if (mousePressed && (IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL)) && isValid && !isTrash && !item.favorite) {
-         playSound("trash");
+         playSound(getAssetHandles().trash);
          items[trashSlot] = item;
          item = {};
       }
       // shift-clicking from trash
       else if (mousePressed && (IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT)) && open && isTrash) {
          placeItem(item);
-         playSound("click");
+         playSound(getAssetHandles().click);
       }
       // swap/discard items
       else if (mousePressed && open && selection.selected) {
-         playSound(i == trashSlot ? "trash" : "click");
+         playSound(i == trashSlot ? getAssetHandles().trash : getAssetHandles().click);
          if (i == selection.lastSelection) {
             discardSelection();
             break;
@@ -115,7 +114,7 @@ void Inventory::update(bool canSwitchOnScroll) {
       }
       // handle selection
       else if (mousePressed && !selection.selected && isValid) {
-         playSound("click");
+         playSound(getAssetHandles().click);
          selection.lastSelection = i;
          selection.selected = true;
          selection.item = item;
@@ -139,7 +138,7 @@ void Inventory::update(bool canSwitchOnScroll) {
             item.count -= free;
             if (item.count <= 0) item = {};
          }
-         playSound("click");
+         playSound(getAssetHandles().click);
       }
 
       if (shouldResetClick) {
@@ -153,7 +152,7 @@ void Inventory::update(bool canSwitchOnScroll) {
 
    // Pressed outside of the inventory
    if (selection.selected && open && isMousePressedOutsideUI(MOUSE_BUTTON_LEFT)) {
-      playSound("click");
+      playSound(getAssetHandles().click);
 
       if (!selection.item.favorite) {
          dropItem(selection.item);
@@ -165,7 +164,7 @@ void Inventory::update(bool canSwitchOnScroll) {
 
 void Inventory::toggleInventoryOpen() {
    if (isKeyPressed(KEY_E)) {
-      playSound(open ? "ui_open_inventory" : "ui_close_inventory");
+      playSound(open ? getAssetHandles().openInventory : getAssetHandles().closeInventory);
       open = !open;
    }
 }
@@ -314,10 +313,11 @@ void Inventory::useSelectedItem() {
 // frame functions
 
 Texture Inventory::getFrameTexture(int i) {
+   const AssetHandles &handles = getAssetHandles();
    if (i == trashSlot) {
-      return getTexture(items[trashSlot].id == 0 ? "small_frame_trash" : "small_frame");
+      return *(items[trashSlot].id == 0 ? handles.smallFrameTrash : handles.smallFrame);
    }
-   return getTexture(i == selected && items[i].favorite ? "small_frame_favorite_selected" : (i == selected ? "small_frame_selected" : (items[i].favorite ? "small_frame_favorite" : "small_frame")));
+   return *(i == selected && items[i].favorite ? handles.smallFrameFavoriteSelected : (i == selected ? handles.smallFrameSelected : (items[i].favorite ? handles.smallFrameFavorite : handles.smallFrame)));
 }
 
 Color Inventory::getItemColor(Item item) {
@@ -349,7 +349,7 @@ void Inventory::render() {
    int columns = inventoryWidth;
    int rows = inventoryHeight + 1;
 
-   Font font = getFont("andy");
+   Font font = *getAssetHandles().font;
    float fontSize = getFontSizeScaled(itemFontSize);
 
    Vector2 size = getGridCellSize(grid, columns, rows) * slotScale;
@@ -1,4 +1,5 @@
 #include "objs/item.hpp"
+#include "mngr/assetHandles.hpp"
 #include "SRU/util.hpp"
 #include "SRU/render.hpp"
 #include "objs/map.hpp"
@@ -129,7 +130,7 @@ void DroppedItem::render() const {
 
    if (count > 1) {
       Vector2 textPosition = position + V2(0.0f, 0.7f);
-      drawText("andy", textPosition, TextFormat("%d", count), 0.75f);
+      drawText(*getAssetHandles().font, textPosition, TextFormat("%d", count), 0.75f);
    }
 }
 
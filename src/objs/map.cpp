@@ -1,9 +1,5 @@
 #include "objs/map.hpp"
-#include "SRU/assets.hpp"
-#include "SRU/render.hpp"
 #include "SRU/util.hpp"
-#include "objs/inventory.hpp"
-#include "objs/parallax.hpp"
 #include "objs/player.hpp"
 #include <unordered_map>
 
@@ -127,76 +123,67 @@ void setLiquid(const std::string &name, const LiquidData &data) {
    liquidData[id] = data;
 }
 
-// constructors
+// helper functions
 
-void Map::init() {
-   initThreadSafe();
-   initContainers();
+static bool isSurfaceBlock(const Block &block) {
+   return block.tile == TileType::ghost || !BlockTypeHas(block.type, BlockType::empty);
 }
 
-void Map::initThreadSafe() {
-   waterTimeShaderLocation = GetShaderLocation(getShader("water"), "time");
-   lightmap = LoadRenderTexture(GetScreenWidth() / 2, GetScreenHeight() / 2);
-}
+// constructors
 
 void Map::initContainers() {
    const int area = sizeX * sizeY;
    blocks = std::vector<Block>(area, Block{});
+   blockStates = std::vector<BlockState>(area, BlockState{});
    walls = std::vector<Wall>(area, Wall{});
    liquidHeights = std::vector<unsigned char>(area, 0);
    liquidTypes = std::vector<liquidid_t>(area, 0);
+
+   chunksX = (sizeX + chunkSize - 1) / chunkSize;
+   chunksY = (sizeY + chunkSize - 1) / chunkSize;
+   chunks = std::vector<MapChunk>(chunksX * chunksY, MapChunk{});
+   unloadedChunks = 0;
+   surfaceHeights = std::vector<int>(sizeX, sizeY);
+   biomes = std::vector<BiomeColumn>(sizeX, BiomeColumn{});
+
+   // fresh blocks are air, the only plane that starts out set is the empty one
+   planeWords = (sizeX + 63) / 64;
+   for (int plane = 0; plane < (int)Plane::count; ++plane) {
+      planes[plane] = std::vector<uint64_t>(planeWords * sizeY, 0);
+   }
+   setPlaneSpan(Plane::empty, 0, area, true);
 }
 
 Map::~Map() {
-   UnloadRenderTexture(lightmap);
+   if (lightmap.id != 0) {
+      UnloadRenderTexture(lightmap);
+   }
 }
 
 // setters
 
-void Map::setRow(int y, const std::string &name) {
-   blockid_t id = getBlockIdFromName(name);
-   Block block = {id, 0, TileType::root, blockData[id].attributes};
-   std::fill_n(&blocks[y * sizeX], sizeX, block);
-}
-
-void Map::setWallRow(int y, const std::string &name) {
-   blockid_t id = getBlockIdFromName(name);
-   Wall wall = {id, blockData[id].attributes};
-   std::fill_n(&walls[y * sizeX], sizeX, wall);
-}
-
-void Map::setColumnFromPoint(int x, int y, const std::string &name) {
-   blockid_t id = getBlockIdFromName(name);
-   BlockType type = blockData[id].attributes;
-
-   Block block {id, 0, TileType::root, type};
-   Wall wall {id, type};
-
-   int start = y * sizeX + x;
-   int end = sizeX * sizeY;
-
-   for (int i = start; i < end; i += sizeX) {
-      blocks[i] = block;
-      walls[i] = wall;
-   }
-}
-
 void Map::fill(int i, int n, blockid_t id) {
-   Block block = {id, 0, TileType::root, blockData[id].attributes};
+   Block block = {id, blockData[id].attributes, TileType::root};
    std::fill_n(&blocks[i], n, block);
+   std::fill_n(&blockStates[i], n, BlockState{});
+   updateSpan(i, n, ChunkFlag::blocks);
 }
 
 void Map::fillWalls(int i, int n, blockid_t id) {
    Wall wall = {id, blockData[id].attributes};
    std::fill_n(&walls[i], n, wall);
+   markDirtySpan(i, n, ChunkFlag::walls);
+   wakeArea(0, i / sizeX - 1, sizeX, (i + n - 1) / sizeX - i / sizeX + 3);
 }
 
 void Map::fillLiquids(int i, int n, liquidid_t id) {
    std::fill_n(&liquidTypes[i], n, id);
+   updateSpan(i, n, ChunkFlag::liquids);
 }
 
 void Map::fillLiquidHeights(int i, int n, liquidlayer_t height) {
    std::fill_n(&liquidHeights[i], n, height);
+   markDirtySpan(i, n, ChunkFlag::liquids);
 }
 
 void Map::setBlock(int x, int y, const std::string &name) {
@@ -207,17 +194,17 @@ void Map::setBlock(int x, int y, blockid_t id) {
    int i = y * sizeX + x;
    Block &block = blocks[i];
    block.id = id;
-   block.ghostId = 0;
    block.tile = TileType::root;
    block.type = blockData[id].attributes;
-   block.value = 0;
-   block.value2 = 0;
-   block.platformOverride = false;
+   blockStates[i] = {};
 
    if (!BlockTypeHas(block.type, BlockType::flowable)) {
       liquidHeights[i] = 0;
       liquidTypes[i] = 0;
+      updateTile(x, y, ChunkFlag::blocks | ChunkFlag::liquids);
+      return;
    }
+   updateTile(x, y, ChunkFlag::blocks);
 }
 
 void Map::setWall(int x, int y, const std::string &name) {
@@ -228,35 +215,220 @@ void Map::setWall(int x, int y, blockid_t id) {
    int i = y * sizeX + x;
    walls[i].id = id;
    walls[i].type = blockData[id].attributes;
+   markDirty(x, y, ChunkFlag::walls);
+   wake(x, y);
 }
 
 void Map::setLiquid(int x, int y, liquidid_t id, liquidlayer_t height) {
    int i = y * sizeX + x;
+   if (liquidTypes[i] == id && liquidHeights[i] == height) {
+      return; // keeps settled liquids asleep
+   }
    liquidTypes[i] = id;
    liquidHeights[i] = height;
+   updateTile(x, y, ChunkFlag::liquids);
+}
+
+// every tile keeps a copy of its block's attributes, so after the block config was reloaded they're copied again and
+// everything worked out from them gets rebuilt. the IDs stay the same, so nothing that gets saved changed and the
+// dirty bits are left alone
+void Map::refreshBlockTypes() {
+   if (sizeX == 0 || sizeY == 0) {
+      return;
+   }
+
+   for (size_t i = 0; i < blocks.size(); ++i) {
+      if (blocks[i].tile == TileType::root) {
+         blocks[i].type = blockData[blocks[i].id].attributes;
+      }
+      walls[i].type = blockData[walls[i].id].attributes;
+   }
+   rebuildPlanes(0, sizeY);
+   rebuildSurface(0, sizeX - 1);
+}
+
+// region writers
+
+void Map::setBlockRect(int x, int y, int width, int height, blockid_t id) {
+   if (width <= 0 || height <= 0) {
+      return;
+   }
+   Block block = {id, blockData[id].attributes, TileType::root};
+   bool clearsLiquids = !BlockTypeHas(block.type, BlockType::flowable);
+
+   for (int yy = y; yy < y + height; ++yy) {
+      int i = yy * sizeX + x;
+      std::fill_n(&blocks[i], width, block);
+      std::fill_n(&blockStates[i], width, BlockState{});
+
+      if (clearsLiquids) {
+         std::fill_n(&liquidHeights[i], width, 0);
+         std::fill_n(&liquidTypes[i], width, 0);
+      }
+   }
+   updateRect(x, y, width, height, (clearsLiquids ? ChunkFlag::blocks | ChunkFlag::liquids : ChunkFlag::blocks));
+}
+
+void Map::setWallRect(int x, int y, int width, int height, blockid_t id) {
+   if (width <= 0 || height <= 0) {
+      return;
+   }
+   Wall wall = {id, blockData[id].attributes};
+
+   for (int yy = y; yy < y + height; ++yy) {
+      std::fill_n(&walls[yy * sizeX + x], width, wall);
+   }
+   updateRect(x, y, width, height, ChunkFlag::walls);
+}
+
+void Map::setLiquidRect(int x, int y, int width, int height, liquidid_t id, liquidlayer_t liquidHeight) {
+   if (width <= 0 || height <= 0) {
+      return;
+   }
+
+   for (int yy = y; yy < y + height; ++yy) {
+      int i = yy * sizeX + x;
+      std::fill_n(&blocks[i], width, Block{});
+      std::fill_n(&blockStates[i], width, BlockState{});
+      std::fill_n(&liquidTypes[i], width, id);
+      std::fill_n(&liquidHeights[i], width, liquidHeight);
+   }
+   updateRect(x, y, width, height, ChunkFlag::blocks | ChunkFlag::liquids);
+}
+
+void Map::setBlockColumn(int x, int y, int height, blockid_t id) {
+   setBlockRect(x, y, 1, height, id);
+}
+
+void Map::setWallColumn(int x, int y, int height, blockid_t id) {
+   setWallRect(x, y, 1, height, id);
+}
+
+// writes ids[i] to (x + i, y) for every set bit i of the mask, same as calling setBlock for each of them
+void Map::setBlockMask(int x, int y, uint64_t mask, const blockid_t *ids) {
+   if (mask == 0) {
+      return;
+   }
+   ChunkFlag flags = ChunkFlag::blocks;
+
+   for (uint64_t bits = mask; bits != 0; bits &= bits - 1) {
+      int offset = __builtin_ctzll(bits);
+      int i = y * sizeX + x + offset;
+      Block &block = blocks[i];
+      block = {ids[offset], blockData[ids[offset]].attributes, TileType::root};
+      blockStates[i] = {};
+
+      if (!BlockTypeHas(block.type, BlockType::flowable)) {
+         liquidHeights[i] = 0;
+         liquidTypes[i] = 0;
+         flags = flags | ChunkFlag::liquids;
+      }
+      updateSurface(x + offset, y);
+      updatePlanes(x + offset, y);
+   }
+
+   int first = __builtin_ctzll(mask);
+   int last = 63 - __builtin_clzll(mask);
+   markDirtyArea(x + first, y, last - first + 1, 1, flags);
+   wakeArea(x + first - 1, y - 1, last - first + 3, 3);
 }
 
 void Map::deleteBlock(int x, int y) {
    int i = y * sizeX + x;
    blocks[i] = {};
+   blockStates[i] = {};
    liquidHeights[i] = 0;
    liquidTypes[i] = 0;
+   updateTile(x, y, ChunkFlag::blocks | ChunkFlag::liquids);
 }
 
 void Map::deleteWall(int x, int y) {
    walls[y * sizeX + x] = {};
+   markDirty(x, y, ChunkFlag::walls);
+   wake(x, y);
 }
 
 void Map::deleteBlockWithoutDeletingLiquids(int x, int y) {
    blocks[y * sizeX + x] = {};
+   blockStates[y * sizeX + x] = {};
+   updateTile(x, y, ChunkFlag::blocks);
 }
 
 void Map::swapBlocks(int oldX, int oldY, int newX, int newY) {
    int oldI = oldY * sizeX + oldX;
    int newI = newY * sizeX + newX;
    std::swap(blocks[oldI], blocks[newI]);
+   std::swap(blockStates[oldI], blockStates[newI]);
+   std::swap(liquidHeights[oldI], liquidHeights[newI]);
+   std::swap(liquidTypes[oldI], liquidTypes[newI]);
+   updateTile(oldX, oldY, ChunkFlag::blocks | ChunkFlag::liquids);
+   updateTile(newX, newY, ChunkFlag::blocks | ChunkFlag::liquids);
+}
+
+void Map::swapLiquids(int oldX, int oldY, int newX, int newY) {
+   int oldI = oldY * sizeX + oldX;
+   int newI = newY * sizeX + newX;
    std::swap(liquidHeights[oldI], liquidHeights[newI]);
    std::swap(liquidTypes[oldI], liquidTypes[newI]);
+   updateTile(oldX, oldY, ChunkFlag::liquids);
+   updateTile(newX, newY, ChunkFlag::liquids);
+}
+
+// keeps chunk flags, the surface and the occupancy planes in sync with a tile that was just written
+void Map::updateTile(int x, int y, ChunkFlag flags) {
+   markDirty(x, y, flags);
+   if (ChunkFlagHas(flags, ChunkFlag::blocks)) {
+      updateSurface(x, y);
+   }
+   updatePlanes(x, y);
+   wake(x, y);
+}
+
+// same as above for fill functions, which write one kind of block or liquid over the whole span
+void Map::updateSpan(int i, int n, ChunkFlag flags) {
+   if (n <= 0) {
+      return;
+   }
+   markDirtySpan(i, n, flags);
+   wakeArea(0, i / sizeX - 1, sizeX, (i + n - 1) / sizeX - i / sizeX + 3);
+   if (ChunkFlagHas(flags, ChunkFlag::blocks)) {
+      const Block &block = blocks[i];
+      bool root = (block.tile == TileType::root);
+      updateSurfaceSpan(i, n);
+      setPlaneSpan(Plane::solid, i, n, root && BlockTypeHas(block.type, BlockType::solid));
+      setPlaneSpan(Plane::platform, i, n, root && BlockTypeHas(block.type, BlockType::platform));
+      setPlaneSpan(Plane::empty, i, n, root && BlockTypeHas(block.type, BlockType::empty));
+   }
+
+   if (ChunkFlagHas(flags, ChunkFlag::liquids)) {
+      setPlaneSpan(Plane::liquid, i, n, liquidTypes[i] != 0);
+   }
+}
+
+// same as above for region writers, which write one kind of block, wall or liquid over the whole rectangle
+void Map::updateRect(int x, int y, int width, int height, ChunkFlag flags) {
+   if (width <= 0 || height <= 0) {
+      return;
+   }
+   markDirtyArea(x, y, width, height, flags);
+   wakeArea(x - 1, y - 1, width + 2, height + 2);
+
+   if (ChunkFlagHas(flags, ChunkFlag::blocks)) {
+      const Block &block = blocks[y * sizeX + x];
+      bool root = (block.tile == TileType::root);
+      bool solid = root && BlockTypeHas(block.type, BlockType::solid);
+      bool platform = root && BlockTypeHas(block.type, BlockType::platform);
+      bool empty = root && BlockTypeHas(block.type, BlockType::empty);
+
+      setPlaneRect(Plane::solid, x, y, width, height, solid);
+      setPlaneRect(Plane::platform, x, y, width, height, platform);
+      setPlaneRect(Plane::empty, x, y, width, height, empty);
+      updateSurfaceRect(x, y, width, height);
+   }
+
+   if (ChunkFlagHas(flags, ChunkFlag::liquids)) {
+      setPlaneRect(Plane::liquid, x, y, width, height, liquidTypes[y * sizeX + x] != 0);
+   }
 }
 
 void Map::updateFurniture(Player &player, Vector2 mousePos, float dt) {
@@ -281,9 +453,10 @@ void Map::addFurniture(Furniture &object) {
          int i = y * sizeX + x;
          blocks[i].tile = TileType::ghost;
          blocks[i].id = object.id;
-         blocks[i].ghostId = identifier;
          blocks[i].type = blockData[0].attributes;
-         blocks[i].platformOverride = piece.walkable;
+         blockStates[i].ghostId = identifier;
+         blockStates[i].platformOverride = piece.walkable;
+         updateTile(x, y, ChunkFlag::blocks);
       }
    }
 
@@ -303,8 +476,9 @@ void Map::removeFurniture(Furniture &object) {
             int i = y * sizeX + x;
             blocks[i].tile = TileType::root;
             blocks[i].id = 0;
-            blocks[i].ghostId = 0;
-            blocks[i].platformOverride = false;
+            blockStates[i].ghostId = 0;
+            blockStates[i].platformOverride = false;
+            updateTile(x, y, ChunkFlag::blocks);
          }
       }
    }
@@ -318,6 +492,15 @@ const Block &Map::getBlock(int x, int y) const {
    return blocks[y * sizeX + x];
 }
 
+// columns outside of the map use the biome of the closest edge
+const BiomeColumn &Map::getBiome(int x) const {
+   return biomes[std::clamp(x, 0, sizeX - 1)];
+}
+
+const BlockState &Map::getBlockState(int x, int y) const {
+   return blockStates[y * sizeX + x];
+}
+
 const Wall &Map::getWall(int x, int y) const {
    return walls[y * sizeX + x];
 }
@@ -356,8 +539,8 @@ bool Map::isStable(int x, int y) const {
 }
 
 bool Map::blockNear(int x, int y) const {
-   return x == 0 || x == sizeX - 1 || y == 0 || y == sizeY - 1 || !isNotSolid(x, y) || !isWall(x, y, BlockType::empty)
-      || !isNotSolid(x + 1, y) || !isNotSolid(x - 1, y) || !isNotSolid(x, y + 1) || !isNotSolid(x, y - 1)
+   return x == 0 || x == sizeX - 1 || y == 0 || y == sizeY - 1 || !isWall(x, y, BlockType::empty)
+      || !allInSpan(Plane::empty, y, x - 1, x + 1) || !testPlane(Plane::empty, x, y + 1) || !testPlane(Plane::empty, x, y - 1)
       || !isWall(x + 1, y, BlockType::empty) || !isWall(x - 1, y, BlockType::empty) || !isWall(x, y + 1, BlockType::empty) || !isWall(x, y - 1, BlockType::empty);
 }
 
@@ -386,176 +569,403 @@ LiquidData &Map::getLiquidData(int x, int y) const {
    return liquidData[liquidTypes[y * sizeX + x]];
 }
 
-// render
+// chunks
 
-void Map::renderLight(const Camera2D &camera, Texture2D &texture, float x, float y, const Vector2 &size, const Color &color) {
-   drawTexture(texture, {(((x + 0.5f - camera.target.x) * camera.zoom) + camera.offset.x) / 2.0f, (((y + 0.5f - camera.target.y) * camera.zoom) + camera.offset.y) / 2.0f}, size, CENTER, color);
+void Map::markDirty(int x, int y, ChunkFlag flags) {
+   MapChunk &chunk = chunks[(y / chunkSize) * chunksX + x / chunkSize];
+   chunk.dirty = chunk.dirty | flags;
 }
 
-void Map::render(const std::vector<DroppedItem> &droppedItems, const Player &player, float accumulator, const Rectangle &cameraBounds, const Camera2D &camera, const Inventory &inventory) {
-   // Render background walls
-   for (int y = cameraBounds.y; y <= cameraBounds.height; ++y) {
-      for (int x = cameraBounds.x; x <= cameraBounds.width; ++x) {
-         int i = y * sizeX + x;
-         Wall &wall = walls[i];
+void Map::markDirtyArea(int x, int y, int width, int height, ChunkFlag flags) {
+   if (width <= 0 || height <= 0) {
+      return;
+   }
+   int minX = std::max(0, x) / chunkSize;
+   int minY = std::max(0, y) / chunkSize;
+   int maxX = std::min(sizeX - 1, x + width - 1) / chunkSize;
+   int maxY = std::min(sizeY - 1, y + height - 1) / chunkSize;
+
+   for (int cy = minY; cy <= maxY; ++cy) {
+      for (int cx = minX; cx <= maxX; ++cx) {
+         MapChunk &chunk = chunks[cy * chunksX + cx];
+         chunk.dirty = chunk.dirty | flags;
+      }
+   }
+}
 
-         if (BlockTypeHas(wall.type, BlockType::empty) || !BlockTypeHas(blocks[i].type, BlockType::translucent)) {
-            continue;
-         }
+// spans come from fill functions, which walk the map in row-major order and may wrap over several rows
+void Map::markDirtySpan(int i, int n, ChunkFlag flags) {
+   if (n <= 0) {
+      return;
+   }
+   int startY = i / sizeX;
+   int endY = (i + n - 1) / sizeX;
 
-         int oldX = x;
-         while (x <= cameraBounds.width && walls[y * sizeX + x].id == wall.id && BlockTypeHas(blocks[y * sizeX + x].type, BlockType::translucent)) {
-            x += 1;
-         }
+   if (startY == endY) {
+      markDirtyArea(i % sizeX, startY, n, 1, flags);
+      return;
+   }
+   markDirtyArea(i % sizeX, startY, sizeX, 1, flags);
+   markDirtyArea(0, startY + 1, sizeX, endY - startY - 1, flags);
+   markDirtyArea(0, endY, (i + n - 1) % sizeX + 1, 1, flags);
+}
 
-         Texture texture = blockData[wall.id].texture;
-         Rectangle source = R4(0, 0, texture.width * (x - oldX), texture.height);
-         drawTexture(texture, V2(oldX, y), V2(x - oldX, 1), TOP_LEFT, wallTint, source, 0.0f);
-         x -= 1;
-      }
+void Map::clearDirty(ChunkFlag flags) {
+   for (MapChunk &chunk: chunks) {
+      chunk.dirty = static_cast<ChunkFlag>(static_cast<unsigned char>(chunk.dirty) & ~static_cast<unsigned char>(flags));
    }
+}
 
-   // Render furniture
-   for (const Furniture &obj: furniture) {
-      if (obj.id != 0) {
-         obj.render(cameraBounds);
+void Map::clearChunkDirty(int chunkX, int chunkY, ChunkFlag flags) {
+   MapChunk &chunk = chunks[chunkY * chunksX + chunkX];
+   chunk.dirty = static_cast<ChunkFlag>(static_cast<unsigned char>(chunk.dirty) & ~static_cast<unsigned char>(flags));
+}
+
+bool Map::isChunkDirty(int chunkX, int chunkY, ChunkFlag flags) const {
+   return ChunkFlagHas(chunks[chunkY * chunksX + chunkX].dirty, flags);
+}
+
+bool Map::anyChunkDirty(ChunkFlag flags) const {
+   for (const MapChunk &chunk: chunks) {
+      if (ChunkFlagHas(chunk.dirty, flags)) {
+         return true;
       }
    }
+   return false;
+}
 
-   // Render blocks
-   for (int y = cameraBounds.y; y <= cameraBounds.height; ++y) {
-      for (int x = cameraBounds.x; x <= cameraBounds.width; ++x) {
-         int i = y * sizeX + x;
-         Block &block = blocks[i];
+MapChunk &Map::getChunk(int x, int y) {
+   return chunks[(y / chunkSize) * chunksX + x / chunkSize];
+}
 
-         if (block.tile != TileType::root || BlockTypeHas(block.type, BlockType::empty)) {
-            continue;
-         }
-         
-         Texture texture = blockData[block.id].texture;
-         if (BlockTypeHas(block.type, BlockType::torch)) {
-            constexpr static float torchLightOffsetsY[] = {-1.0f, -1.0f * (5.0f / 8.0f), -0.75f, -0.75f, -1.0f * (5.0f / 8.0f)};
-
-            float textureSize = texture.height / 2.0f;
-            DrawTexturePro(texture, {textureSize * block.value2, 0, textureSize, textureSize}, {(float)x, (float)y, 1, 1}, {0, 0}, 0, WHITE);
-            DrawTexturePro(texture, {textureSize * block.value, textureSize, textureSize, textureSize}, {(float)x, (float)y + torchLightOffsetsY[block.value2], 1, 1}, {0, 0}, 0, WHITE);
-            continue;
+void Map::setChunkLoaded(int chunkX, int chunkY, bool loaded) {
+   MapChunk &chunk = chunks[chunkY * chunksX + chunkX];
+   unloadedChunks += (chunk.loaded && !loaded) - (!chunk.loaded && loaded);
+   chunk.loaded = loaded;
+}
+
+// tiles outside of the map count as loaded, there's nothing there to wait for
+bool Map::isLoaded(int x, int y) const {
+   return unloadedChunks == 0 || !isPositionValid(x, y) || chunks[(y / chunkSize) * chunksX + x / chunkSize].loaded;
+}
+
+bool Map::isAreaLoaded(int x, int y, int width, int height) const {
+   if (unloadedChunks == 0) {
+      return true;
+   }
+   int minChunkX = std::max(0, x) / chunkSize, maxChunkX = std::min(sizeX - 1, x + width - 1) / chunkSize;
+   int minChunkY = std::max(0, y) / chunkSize, maxChunkY = std::min(sizeY - 1, y + height - 1) / chunkSize;
+
+   for (int chunkY = minChunkY; chunkY <= maxChunkY; ++chunkY) {
+      for (int chunkX = minChunkX; chunkX <= maxChunkX; ++chunkX) {
+         if (!chunks[chunkY * chunksX + chunkX].loaded) {
+            return false;
          }
+      }
+   }
+   return true;
+}
+
+// surface
+
+int Map::getSurfaceY(int x) const {
+   return surfaceHeights[x];
+}
+
+void Map::updateSurface(int x, int y) {
+   updateSurfaceSpan(y * sizeX + x, 1);
+}
 
-         // Render regular blocks
-         int oldX = x;
-         while (x <= cameraBounds.width && blocks[y * sizeX + x].tile == TileType::root && blocks[y * sizeX + x].id == block.id) {
-            x += 1;
+// the span was just filled with one kind of block, so only the first tile of each column decides whether the surface
+// rises. if the old surface tile got emptied, walk down until the next block
+void Map::updateSurfaceSpan(int i, int n) {
+   bool solid = isSurfaceBlock(blocks[i]);
+   int count = std::min(n, sizeX);
+
+   for (int k = i; k < i + count; ++k) {
+      int x = k % sizeX;
+      int y = k / sizeX;
+      int &surface = surfaceHeights[x];
+
+      if (solid) {
+         surface = std::min(surface, y);
+         continue;
+      }
+
+      int lastY = (i + n - 1 - x) / sizeX;
+      if (surface < y || surface > lastY) {
+         continue;
+      }
+
+      while (surface < sizeY && !isSurfaceBlock(blocks[surface * sizeX + x])) {
+         surface += 1;
+      }
+   }
+}
+
+// same as updateSurfaceSpan for a rectangle filled with one kind of block. columns whose surface was inside of it walk
+// down from its bottom edge
+void Map::updateSurfaceRect(int x, int y, int width, int height) {
+   bool solid = isSurfaceBlock(blocks[y * sizeX + x]);
+
+   for (int xx = x; xx < x + width; ++xx) {
+      int &surface = surfaceHeights[xx];
+      if (solid) {
+         surface = std::min(surface, y);
+         continue;
+      }
+
+      if (surface < y || surface >= y + height) {
+         continue;
+      }
+      surface = y + height;
+
+      while (surface < sizeY && !isSurfaceBlock(blocks[surface * sizeX + xx])) {
+         surface += 1;
+      }
+   }
+}
+
+// for rows minY to maxY - 1 written straight into the lanes after the rest of the map, when they were all air before.
+// surfaces can only move up into them
+void Map::updateSurfaceRows(int minY, int maxY) {
+   for (int y = minY; y < maxY; ++y) {
+      for (int x = 0; x < sizeX; ++x) {
+         if (surfaceHeights[x] > y && isSurfaceBlock(blocks[y * sizeX + x])) {
+            surfaceHeights[x] = y;
          }
+      }
+   }
+}
+
+// for tiles written straight into the lanes. walks the columns minX to maxX (inclusive) down row by row until each one
+// has found its surface
+void Map::rebuildSurface(int minX, int maxX) {
+   std::fill(&surfaceHeights[minX], &surfaceHeights[maxX] + 1, sizeY);
+   int remaining = maxX - minX + 1;
 
-         Rectangle source = R4(0, 0, texture.width * (x - oldX), texture.height);
-         drawTexture(texture, V2(oldX, y), V2(x - oldX, 1), TOP_LEFT, WHITE, source, 0.0f);
-         x -= 1;
+   for (int y = 0; y < sizeY && remaining > 0; ++y) {
+      for (int x = minX; x <= maxX; ++x) {
+         if (surfaceHeights[x] == sizeY && isSurfaceBlock(blocks[y * sizeX + x])) {
+            surfaceHeights[x] = y;
+            remaining -= 1;
+         }
       }
    }
+}
+
+// occupancy planes
 
-   // Render the player
-   if (player.hearts != 0) {
-      player.render(accumulator);
+void Map::updatePlanes(int x, int y) {
+   int i = y * sizeX + x;
+   const Block &block = blocks[i];
+   bool root = (block.tile == TileType::root);
+
+   setPlaneBit(Plane::solid, x, y, root && BlockTypeHas(block.type, BlockType::solid));
+   setPlaneBit(Plane::platform, x, y, (root && BlockTypeHas(block.type, BlockType::platform)) || blockStates[i].platformOverride);
+   setPlaneBit(Plane::empty, x, y, root && BlockTypeHas(block.type, BlockType::empty));
+   setPlaneBit(Plane::liquid, x, y, liquidTypes[i] != 0);
+}
+
+void Map::setPlaneBit(Plane plane, int x, int y, bool value) {
+   uint64_t &word = planes[(int)plane][y * planeWords + (x >> 6)];
+   uint64_t mask = uint64_t(1) << (x & 63);
+   word = (value ? word | mask : word & ~mask);
+}
+
+// sets bits minX to maxX (inclusive) of a row
+void Map::setPlaneRange(Plane plane, int y, int minX, int maxX, bool value) {
+   uint64_t *row = &planes[(int)plane][y * planeWords];
+   int firstWord = minX >> 6;
+   int lastWord = maxX >> 6;
+
+   for (int word = firstWord; word <= lastWord; ++word) {
+      uint64_t mask = ~uint64_t(0);
+      if (word == firstWord) mask &= ~uint64_t(0) << (minX & 63);
+      if (word == lastWord)  mask &= ~uint64_t(0) >> (63 - (maxX & 63));
+      row[word] = (value ? row[word] | mask : row[word] & ~mask);
    }
+}
 
-   for (const DroppedItem &droppedItem : droppedItems) {
-      droppedItem.render();
+void Map::setPlaneSpan(Plane plane, int i, int n, bool value) {
+   while (n > 0) {
+      int x = i % sizeX;
+      int count = std::min(n, sizeX - x);
+      setPlaneRange(plane, i / sizeX, x, x + count - 1, value);
+      i += count;
+      n -= count;
    }
+}
 
-   // Render fluids
-   Shader &waterShader = getShader("water");
-   float time = GetTime();
-   SetShaderValue(waterShader, waterTimeShaderLocation, &time, SHADER_UNIFORM_FLOAT);
-   BeginShaderMode(waterShader);
+// same as setPlaneRange over several rows, the masks only depend on the columns so they're worked out once
+void Map::setPlaneRect(Plane plane, int x, int y, int width, int height, bool value) {
+   int minX = x;
+   int maxX = x + width - 1;
+   int firstWord = minX >> 6;
+   int lastWord = maxX >> 6;
+   uint64_t firstMask = ~uint64_t(0) << (minX & 63);
+   uint64_t lastMask = ~uint64_t(0) >> (63 - (maxX & 63));
+
+   for (int yy = y; yy < y + height; ++yy) {
+      uint64_t *row = &planes[(int)plane][yy * planeWords];
+      for (int word = firstWord; word <= lastWord; ++word) {
+         uint64_t mask = ~uint64_t(0);
+         if (word == firstWord) mask &= firstMask;
+         if (word == lastWord)  mask &= lastMask;
+         row[word] = (value ? row[word] | mask : row[word] & ~mask);
+      }
+   }
+}
 
-   // Render fluids
-   for (int y = cameraBounds.y; y <= cameraBounds.height; ++y) {
-      for (int x = cameraBounds.x; x <= cameraBounds.width; ++x) {
-         if (!isLiquid(x, y)) {
-            continue;
+// for tiles written straight into the lanes. rows minY to maxY - 1 get all of their planes worked out again, a word
+// at a time, and every cell in them is woken up like the fill functions would
+void Map::rebuildPlanes(int minY, int maxY) {
+   for (int y = minY; y < maxY; ++y) {
+      for (int word = 0; word < planeWords; ++word) {
+         uint64_t solid = 0, platform = 0, empty = 0, liquid = 0, awake = 0;
+         int minX = word * 64;
+         int count = std::min(64, sizeX - minX);
+
+         for (int bit = 0; bit < count; ++bit) {
+            int i = y * sizeX + minX + bit;
+            const Block &block = blocks[i];
+            bool root = (block.tile == TileType::root);
+            uint64_t mask = uint64_t(1) << bit;
+
+            solid |= (root && BlockTypeHas(block.type, BlockType::solid) ? mask : 0);
+            platform |= ((root && BlockTypeHas(block.type, BlockType::platform)) || blockStates[i].platformOverride ? mask : 0);
+            empty |= (root && BlockTypeHas(block.type, BlockType::empty) ? mask : 0);
+            liquid |= (liquidTypes[i] != 0 ? mask : 0);
+            awake |= mask;
          }
 
-         float height = (float)getLiquidHeight(x, y) / (float)maxLiquidLayers;
-         Color liquidFlags;
-         liquidFlags.r = (isStable(x, y - 1) ? 255 : 0);
-         liquidFlags.g = (!isAnyLiquid(x, y + 1) || !isLiquidOfType(x, y + 1, liquidTypes[y * sizeX + x]) ? 255 : 0);
-         liquidFlags.b = height * 255.0f;
-   
-         Texture texture = getLiquidData(x, y).texture;
-         Rectangle source = R4(0, texture.height - texture.height * height, texture.width, texture.height * height);
-         drawTexture(texture, V2(x, y + (1 - height)), V2(1, height), TOP_LEFT, Fade(liquidFlags, height), source, 0.0f);
+         int index = y * planeWords + word;
+         planes[(int)Plane::solid][index] = solid;
+         planes[(int)Plane::platform][index] = platform;
+         planes[(int)Plane::empty][index] = empty;
+         planes[(int)Plane::liquid][index] = liquid;
+         planes[(int)Plane::awake][index] = awake;
       }
    }
-   EndShaderMode();
+}
 
-   // Render lights
-   BeginTextureMode(lightmap);
-   ClearBackground(BLACK);
-   BeginBlendMode(BLEND_ADDITIVE);
+bool Map::testPlane(Plane plane, int x, int y) const {
+   return isPositionValid(x, y) && (planes[(int)plane][y * planeWords + (x >> 6)] >> (x & 63)) & 1;
+}
 
-   int lightBoundsMinX = std::max<int>(0, cameraBounds.x - 8);
-   int lightBoundsMinY = std::max<int>(0, cameraBounds.y - 8);
-   int lightBoundsMaxX = std::min<int>(sizeX - 1, cameraBounds.width + 8);
-   int lightBoundsMaxY = std::min<int>(sizeY - 1, cameraBounds.height + 8);
+// returns up to 64 bits starting at x, bit 0 being x itself. tiles outside of the map read as 0
+uint64_t Map::getPlaneBits(Plane plane, int x, int y, int count) const {
+   if (y < 0 || y >= sizeY || count <= 0) {
+      return 0;
+   }
 
-   Color airLightColor   = getLightBasedOnTime();
-   Color waterLightColor = Fade(airLightColor, 0.1f);
+   int shift = 0;
+   if (x < 0) {
+      shift = -x;
+      count -= shift;
+      x = 0;
+   }
+   count = std::min(count, sizeX - x);
+   if (count <= 0) {
+      return 0;
+   }
 
-   // const function hack
-   static float counter = 0.0f;
-   counter += GetFrameTime();
+   const uint64_t *row = &planes[(int)plane][y * planeWords];
+   int word = x >> 6;
+   int bit = x & 63;
 
-   float sizeOffset     = std::sin(counter * 1.5f) * camera.zoom * 0.4f;
-   float positionOffset = std::cos(counter * 0.8f) * camera.zoom * 0.0075f;
+   uint64_t bits = row[word] >> bit;
+   if (bit != 0 && bit + count > 64) {
+      bits |= row[word + 1] << (64 - bit);
+   }
+   if (count < 64) {
+      bits &= (uint64_t(1) << count) - 1;
+   }
+   return bits << shift;
+}
+
+bool Map::anyInSpan(Plane plane, int y, int minX, int maxX) const {
+   if (y < 0 || y >= sizeY) {
+      return false;
+   }
+   minX = std::max(minX, 0);
+   maxX = std::min(maxX, sizeX - 1);
+
+   const uint64_t *row = &planes[(int)plane][y * planeWords];
+   int firstWord = minX >> 6;
+   int lastWord = maxX >> 6;
+
+   for (int word = firstWord; word <= lastWord && minX <= maxX; ++word) {
+      uint64_t mask = ~uint64_t(0);
+      if (word == firstWord) mask &= ~uint64_t(0) << (minX & 63);
+      if (word == lastWord)  mask &= ~uint64_t(0) >> (63 - (maxX & 63));
+      if (row[word] & mask) {
+         return true;
+      }
+   }
+   return false;
+}
 
-   Vector2 lightSize      = {3.5f * camera.zoom, 3.5f * camera.zoom};
-   Vector2 lightLargeSize = {lightSize.x + lightSize.x, lightSize.y + lightSize.y};
-   Vector2 lightHugeSize  = {lightLargeSize.x + lightSize.x, lightLargeSize.y + lightSize.y};
-   Vector2 liquidSize     = {lightSize.x + sizeOffset, lightSize.y + sizeOffset};
+// tiles outside of the map count as unset, same as Map::is
+bool Map::allInSpan(Plane plane, int y, int minX, int maxX) const {
+   if (y < 0 || y >= sizeY || minX < 0 || maxX >= sizeX || minX > maxX) {
+      return false;
+   }
 
-   Texture2D &lightHugeTexture  = getTexture("lightsource_6x");
-   Texture2D &lightLargeTexture = getTexture("lightsource_4x");
-   Texture2D &lightTexture      = getTexture("lightsource_2x");
+   const uint64_t *row = &planes[(int)plane][y * planeWords];
+   int firstWord = minX >> 6;
+   int lastWord = maxX >> 6;
 
-   for (int y = lightBoundsMinY; y <= lightBoundsMaxY; ++y) {
-      for (int x = lightBoundsMinX; x <= lightBoundsMaxX; ++x) {
-         BlockType type = blocks[y * sizeX + x].type;
-         if (!BlockTypeHas(type, BlockType::lightsource) && !BlockTypeHas(type, BlockType::translucent)) {
-            continue;
-         }
+   for (int word = firstWord; word <= lastWord; ++word) {
+      uint64_t mask = ~uint64_t(0);
+      if (word == firstWord) mask &= ~uint64_t(0) << (minX & 63);
+      if (word == lastWord)  mask &= ~uint64_t(0) >> (63 - (maxX & 63));
+      if ((row[word] & mask) != mask) {
+         return false;
+      }
+   }
+   return true;
+}
 
-         // Direct light sources, ones who do not require the wall behind to be transparent
-         if (isAnyLiquid(x, y) && getLiquidData(x, y).glow) {
-            if (isLiquid(x, y)) {
-               renderLight(camera, lightTexture, x + positionOffset, y + positionOffset, liquidSize, {255, 125, 0, 255});
-            }
-            continue;
-         } else if (BlockTypeHas(type, BlockType::torch)) {
-            renderLight(camera, lightHugeTexture, x + positionOffset, y + positionOffset, lightHugeSize, {255, 200, 160, 255}); // Light orange
-         } else if (BlockTypeHas(type, BlockType::lightsource)) {
-            renderLight(camera, lightLargeTexture, x, y, lightLargeSize, {255, 255, 0, 255});
-         }
+// highest x within minX and maxX (inclusive, both inside the map) whose bit is set. minX - 1 if there's none
+int Map::findLastInSpan(Plane plane, int y, int minX, int maxX) const {
+   const uint64_t *row = &planes[(int)plane][y * planeWords];
+   int firstWord = minX >> 6;
+   int lastWord = maxX >> 6;
 
-         if (!BlockTypeHas(walls[y * sizeX + x].type, BlockType::translucent)) {
-            continue;
-         }
+   for (int word = lastWord; word >= firstWord && minX <= maxX; --word) {
+      uint64_t bits = row[word];
+      if (word == lastWord)  bits &= ~uint64_t(0) >> (63 - (maxX & 63));
+      if (word == firstWord) bits &= ~uint64_t(0) << (minX & 63);
 
-         // Indirect light sources, these require to background to be empty
-         if (isLiquid(x, y) && getLiquidData(x, y).naturalLight) {
-            renderLight(camera, lightTexture, x, y, lightSize, waterLightColor);
-            continue;
-         }
-         renderLight(camera, lightTexture, x, y, lightSize, airLightColor);
+      if (bits != 0) {
+         return word * 64 + 63 - __builtin_clzll(bits);
       }
    }
+   return minX - 1;
+}
+
+// physics scheduling. a change can affect every cell around it, so wake the whole neighbourhood
 
-   EndBlendMode();
-   EndTextureMode();
+void Map::wake(int x, int y) {
+   wakeArea(x - 1, y - 1, 3, 3);
+}
 
-   BeginBlendMode(BLEND_MULTIPLIED);
-   DrawTexturePro(lightmap.texture, {0, 0, (float)lightmap.texture.width, -(float)lightmap.texture.height}, {0, 0, (float)GetScreenWidth(), (float)GetScreenHeight()}, {0, 0}, 0, WHITE);
-   EndBlendMode();
+void Map::wakeArea(int x, int y, int width, int height) {
+   int minX = std::max(0, x);
+   int maxX = std::min(sizeX - 1, x + width - 1);
+   int minY = std::max(0, y);
+   int maxY = std::min(sizeY - 1, y + height - 1);
+
+   if (minX <= maxX && minY <= maxY) {
+      setPlaneRect(Plane::awake, minX, minY, maxX - minX + 1, maxY - minY + 1, true);
+   }
+}
+
+void Map::keepAwake(int x, int y) {
+   setPlaneBit(Plane::awake, x, y, true);
+}
 
-   BeginMode2D(camera); // EndTextureMode disables it for some reason
+void Map::sleep(int x, int y) {
+   setPlaneBit(Plane::awake, x, y, false);
 }
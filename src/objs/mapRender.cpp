@@ -0,0 +1,197 @@
+#include "objs/map.hpp"
+#include "mngr/assetHandles.hpp"
+#include "SRU/render.hpp"
+#include "SRU/util.hpp"
+#include "objs/inventory.hpp"
+#include "objs/parallax.hpp"
+#include "objs/player.hpp"
+
+// Map functions that need a window. kept apart from objs/map.cpp so the simulation builds without them
+
+// constructors
+
+void Map::init() {
+   initThreadSafe();
+   initContainers();
+}
+
+void Map::initThreadSafe() {
+   waterTimeShaderLocation = GetShaderLocation(*getAssetHandles().water, "time");
+   lightmap = LoadRenderTexture(GetScreenWidth() / 2, GetScreenHeight() / 2);
+}
+
+
+// render
+
+void Map::renderLight(const Camera2D &camera, Texture2D &texture, float x, float y, const Vector2 &size, const Color &color) {
+   drawTexture(texture, {(((x + 0.5f - camera.target.x) * camera.zoom) + camera.offset.x) / 2.0f, (((y + 0.5f - camera.target.y) * camera.zoom) + camera.offset.y) / 2.0f}, size, CENTER, color);
+}
+
+void Map::render(const std::vector<DroppedItem> &droppedItems, const Player &player, float accumulator, const Rectangle &cameraBounds, const Camera2D &camera, const Inventory &inventory) {
+   // Render background walls
+   for (int y = cameraBounds.y; y <= cameraBounds.height; ++y) {
+      for (int x = cameraBounds.x; x <= cameraBounds.width; ++x) {
+         int i = y * sizeX + x;
+         Wall &wall = walls[i];
+
+         if (BlockTypeHas(wall.type, BlockType::empty) || !BlockTypeHas(blocks[i].type, BlockType::translucent)) {
+            continue;
+         }
+
+         int oldX = x;
+         while (x <= cameraBounds.width && walls[y * sizeX + x].id == wall.id && BlockTypeHas(blocks[y * sizeX + x].type, BlockType::translucent)) {
+            x += 1;
+         }
+
+         Texture texture = getBlockData(wall.id).texture;
+         Rectangle source = R4(0, 0, texture.width * (x - oldX), texture.height);
+         drawTexture(texture, V2(oldX, y), V2(x - oldX, 1), TOP_LEFT, wallTint, source, 0.0f);
+         x -= 1;
+      }
+   }
+
+   // Render furniture
+   for (const Furniture &obj: furniture) {
+      if (obj.id != 0) {
+         obj.render(cameraBounds);
+      }
+   }
+
+   // Render blocks
+   for (int y = cameraBounds.y; y <= cameraBounds.height; ++y) {
+      for (int x = cameraBounds.x; x <= cameraBounds.width; ++x) {
+         int i = y * sizeX + x;
+         Block &block = blocks[i];
+
+         if (block.tile != TileType::root || BlockTypeHas(block.type, BlockType::empty)) {
+            continue;
+         }
+         
+         Texture texture = getBlockData(block.id).texture;
+         if (BlockTypeHas(block.type, BlockType::torch)) {
+            constexpr static float torchLightOffsetsY[] = {-1.0f, -1.0f * (5.0f / 8.0f), -0.75f, -0.75f, -1.0f * (5.0f / 8.0f)};
+
+            const BlockState &state = blockStates[i];
+            float textureSize = texture.height / 2.0f;
+            DrawTexturePro(texture, {textureSize * state.value2, 0, textureSize, textureSize}, {(float)x, (float)y, 1, 1}, {0, 0}, 0, WHITE);
+            DrawTexturePro(texture, {textureSize * state.value, textureSize, textureSize, textureSize}, {(float)x, (float)y + torchLightOffsetsY[state.value2], 1, 1}, {0, 0}, 0, WHITE);
+            continue;
+         }
+
+         // Render regular blocks
+         int oldX = x;
+         while (x <= cameraBounds.width && blocks[y * sizeX + x].tile == TileType::root && blocks[y * sizeX + x].id == block.id) {
+            x += 1;
+         }
+
+         Rectangle source = R4(0, 0, texture.width * (x - oldX), texture.height);
+         drawTexture(texture, V2(oldX, y), V2(x - oldX, 1), TOP_LEFT, WHITE, source, 0.0f);
+         x -= 1;
+      }
+   }
+
+   // Render the player
+   if (player.hearts != 0) {
+      player.render(accumulator);
+   }
+
+   for (const DroppedItem &droppedItem : droppedItems) {
+      droppedItem.render();
+   }
+
+   // Render fluids
+   Shader &waterShader = *getAssetHandles().water;
+   float time = GetTime();
+   SetShaderValue(waterShader, waterTimeShaderLocation, &time, SHADER_UNIFORM_FLOAT);
+   BeginShaderMode(waterShader);
+
+   // Render fluids
+   for (int y = cameraBounds.y; y <= cameraBounds.height; ++y) {
+      for (int x = cameraBounds.x; x <= cameraBounds.width; ++x) {
+         if (!isLiquid(x, y)) {
+            continue;
+         }
+
+         float height = (float)getLiquidHeight(x, y) / (float)maxLiquidLayers;
+         Color liquidFlags;
+         liquidFlags.r = (isStable(x, y - 1) ? 255 : 0);
+         liquidFlags.g = (!isAnyLiquid(x, y + 1) || !isLiquidOfType(x, y + 1, liquidTypes[y * sizeX + x]) ? 255 : 0);
+         liquidFlags.b = height * 255.0f;
+   
+         Texture texture = getLiquidData(x, y).texture;
+         Rectangle source = R4(0, texture.height - texture.height * height, texture.width, texture.height * height);
+         drawTexture(texture, V2(x, y + (1 - height)), V2(1, height), TOP_LEFT, Fade(liquidFlags, height), source, 0.0f);
+      }
+   }
+   EndShaderMode();
+
+   // Render lights
+   BeginTextureMode(lightmap);
+   ClearBackground(BLACK);
+   BeginBlendMode(BLEND_ADDITIVE);
+
+   int lightBoundsMinX = std::max<int>(0, cameraBounds.x - 8);
+   int lightBoundsMinY = std::max<int>(0, cameraBounds.y - 8);
+   int lightBoundsMaxX = std::min<int>(sizeX - 1, cameraBounds.width + 8);
+   int lightBoundsMaxY = std::min<int>(sizeY - 1, cameraBounds.height + 8);
+
+   Color airLightColor   = getLightBasedOnTime();
+   Color waterLightColor = Fade(airLightColor, 0.1f);
+
+   // const function hack
+   static float counter = 0.0f;
+   counter += GetFrameTime();
+
+   float sizeOffset     = std::sin(counter * 1.5f) * camera.zoom * 0.4f;
+   float positionOffset = std::cos(counter * 0.8f) * camera.zoom * 0.0075f;
+
+   Vector2 lightSize      = {3.5f * camera.zoom, 3.5f * camera.zoom};
+   Vector2 lightLargeSize = {lightSize.x + lightSize.x, lightSize.y + lightSize.y};
+   Vector2 lightHugeSize  = {lightLargeSize.x + lightSize.x, lightLargeSize.y + lightSize.y};
+   Vector2 liquidSize     = {lightSize.x + sizeOffset, lightSize.y + sizeOffset};
+
+   Texture2D &lightHugeTexture  = *getAssetHandles().lightHuge;
+   Texture2D &lightLargeTexture = *getAssetHandles().lightLarge;
+   Texture2D &lightTexture      = *getAssetHandles().light;
+
+   for (int y = lightBoundsMinY; y <= lightBoundsMaxY; ++y) {
+      for (int x = lightBoundsMinX; x <= lightBoundsMaxX; ++x) {
+         BlockType type = blocks[y * sizeX + x].type;
+         if (!BlockTypeHas(type, BlockType::lightsource) && !BlockTypeHas(type, BlockType::translucent)) {
+            continue;
+         }
+
+         // Direct light sources, ones who do not require the wall behind to be transparent
+         if (isAnyLiquid(x, y) && getLiquidData(x, y).glow) {
+            if (isLiquid(x, y)) {
+               renderLight(camera, lightTexture, x + positionOffset, y + positionOffset, liquidSize, {255, 125, 0, 255});
+            }
+            continue;
+         } else if (BlockTypeHas(type, BlockType::torch)) {
+            renderLight(camera, lightHugeTexture, x + positionOffset, y + positionOffset, lightHugeSize, {255, 200, 160, 255}); // Light orange
+         } else if (BlockTypeHas(type, BlockType::lightsource)) {
+            renderLight(camera, lightLargeTexture, x, y, lightLargeSize, {255, 255, 0, 255});
+         }
+
+         if (!BlockTypeHas(walls[y * sizeX + x].type, BlockType::translucent)) {
+            continue;
+         }
+
+         // Indirect light sources, these require to background to be empty
+         if (isLiquid(x, y) && getLiquidData(x, y).naturalLight) {
+            renderLight(camera, lightTexture, x, y, lightSize, waterLightColor);
+            continue;
+         }
+         renderLight(camera, lightTexture, x, y, lightSize, airLightColor);
+      }
+   }
+
+   EndBlendMode();
+   EndTextureMode();
+
+   BeginBlendMode(BLEND_MULTIPLIED);
+   DrawTexturePro(lightmap.texture, {0, 0, (float)lightmap.texture.width, -(float)lightmap.texture.height}, {0, 0, (float)GetScreenWidth(), (float)GetScreenHeight()}, {0, 0}, 0, WHITE);
+   EndBlendMode();
+
+   BeginMode2D(camera); // EndTextureMode disables it for some reason
+}
@@ -1,5 +1,5 @@
 #include "objs/parallax.hpp"
-#include "SRU/assets.hpp"
+#include "mngr/assetHandles.hpp"
 #include "SRU/random.hpp"
 #include "SRU/render.hpp"
 #include "SRU/util.hpp"
@@ -131,7 +131,7 @@ void drawBackground(float bgSpeed, float fgSpeed, float daySpeed) {
    float t = getFadeStrengthBasedOnTime();
 
    // Draw the sky
-   drawTexture("sky", getWindowArea(), TOP_LEFT, ColorLerp(skyColorDay, skyColorNight, t));
+   drawTexture(*getAssetHandles().sky, getWindowArea(), TOP_LEFT, ColorLerp(skyColorDay, skyColorNight, t));
 
    // Draw the stars
    if (prevMoonPhase != moonPhase) {
@@ -145,7 +145,7 @@ void drawBackground(float bgSpeed, float fgSpeed, float daySpeed) {
       }
    }
 
-   Texture &starTexture = getTexture("stars");
+   Texture &starTexture = *getAssetHandles().stars;
    for (int i = 0; i < starCount; ++i) {
       Star &star = stars[i];
       DrawTexturePro(starTexture, {(float)star.frameX * starTexture.height, 0.0f, (float)starTexture.height, (float)starTexture.height}, {star.position.x * screenSize.x, star.position.y * screenSize.y, star.size.x, star.size.y}, {0, 0}, 0, Fade(WHITE, 0.5f - (1.0f - t)));
@@ -153,13 +153,13 @@ void drawBackground(float bgSpeed, float fgSpeed, float daySpeed) {
 
    // Draw either moon or sun based on the time
    if (isNight) {
-      Texture &texture = getTexture("moon");
+      Texture &texture = *getAssetHandles().moon;
       Vector2 position = {origin.x, screenSize.y};
       Vector2 size = mapRatioToArea(moonSize, WINDOW_AREA, CUBIC_RATIO);
 
       DrawTexturePro(texture, {(float)moonPhase * texture.height, 0.0f, (float)texture.height, (float)texture.height}, {position.x, position.y, size.x, size.y}, origin, currentTime - 180.0f, WHITE);
    } else {
-      Texture &texture = getTexture("sun");
+      Texture &texture = *getAssetHandles().sun;
       Vector2 position = {origin.x, screenSize.y};
       Vector2 size = mapRatioToArea(sunSize, WINDOW_AREA, CUBIC_RATIO);
 
@@ -207,8 +207,8 @@ Color getLightBasedOnTime() {
 
 void setCurrentBackgroundBiome(MapGenerator::Biome biome) {
    if (::biome != biome || !bgTexture || !fgTexture) {
-      bgTexture = &getTexture(randomElement(biomeBackgroundTextures[(size_t)biome]));
-      fgTexture = &getTexture(randomElement(biomeForegroundTextures[(size_t)biome]));   
+      bgTexture = &lookupTexture(randomElement(biomeBackgroundTextures[(size_t)biome]));
+      fgTexture = &lookupTexture(randomElement(biomeForegroundTextures[(size_t)biome]));   
    }
    ::biome = biome;
 }
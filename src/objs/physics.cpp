@@ -0,0 +1,381 @@
+#include "objs/physics.hpp"
+#include "mngr/random.hpp"
+#include "mngr/threadPool.hpp"
+#include <algorithm>
+
+// Constants
+
+constexpr int physicsStripWidth = 64; // one word of a map plane
+constexpr int physicsPhases = 3;
+
+// Constructors
+
+Physics::Physics(Map &map)
+   : map(map) {}
+
+void Physics::init() {
+   liquidCounters = std::vector<int>(getLiquidCount(), 0);
+   farLiquidCounters = std::vector<int>(getLiquidCount(), 0);
+}
+
+// Update
+
+void Physics::fixedUpdate(const Rectangle &cameraBounds) {
+   physicsCounter = (physicsCounter + 1) % physicsTicks;
+   if (physicsCounter == 0) {
+      updateNearPhysics(cameraBounds);
+   }
+   updateFarPhysics();
+}
+
+// Block physic update functions
+
+static void advanceLiquidCounters(std::vector<int> &counters) {
+   for (liquidid_t i = 1; i < counters.size(); ++i) {
+      if (counters[i] >= getLiquidData(i).updateSpeed) {
+         counters[i] = 0;
+      }
+      counters[i] += 1;
+   }
+}
+
+void Physics::updateNearPhysics(const Rectangle &cameraBounds) {
+   physicsBounds = cameraBounds;
+   Vector2 halfSize = {(cameraBounds.width - cameraBounds.x) / 2.0f, (cameraBounds.height - cameraBounds.y) / 2.0f};
+   physicsBounds.x = std::max<int>(0, cameraBounds.x - halfSize.x);
+   physicsBounds.y = std::max<int>(0, cameraBounds.y - halfSize.y);
+   physicsBounds.width = std::min<int>(map.sizeX - 1, cameraBounds.width + halfSize.x);
+   physicsBounds.height = std::min<int>(map.sizeY - 1, cameraBounds.height + halfSize.y);
+
+   advanceLiquidCounters(liquidCounters);
+   physicsTick += 1;
+   farPhysicsCounter += 1;
+   cellsUpdated = 0;
+
+   int firstStrip = physicsBounds.x / physicsStripWidth;
+   int lastStrip = physicsBounds.width / physicsStripWidth;
+   for (int phase = 0; phase < physicsPhases; ++phase) {
+      std::vector<int> strips;
+      for (int strip = firstStrip + phase; strip <= lastStrip; strip += physicsPhases) {
+         strips.push_back(strip);
+      }
+      cellsUpdated += updatePhysicsStrips(strips, physicsBounds, nullptr, liquidCounters, mixBits(map.seed) ^ physicsTick);
+   }
+}
+
+void Physics::updateFarPhysics() {
+   // The rest of the map ticks once every farPhysicsRate near ticks. a far tick is handed out farPhysicsCells cells
+   // every fixed update, a band of rows across every strip of the current phase, so no update does more than that no
+   // matter how big the map is. the bands go from the bottom up like a strip loops on its own, which keeps the results
+   // the same as updating whole strips. the slices depend only on the tick count and the map, never on the time, so
+   // the same game plays out the same on any machine. near cells are skipped, they're already up to date
+   if (!farPhysics || map.sizeX <= 0) {
+      farPhysicsCounter = 0;
+      return;
+   }
+
+   if (!farPhysicsActive) {
+      if (farPhysicsCounter < farPhysicsRate) {
+         return;
+      }
+      farPhysicsCounter = 0;
+      farPhysicsActive = true;
+      farPhysicsPhase = 0;
+      farPhysicsRow = map.sizeY - 1;
+      farCellsPending = 0;
+      advanceLiquidCounters(farLiquidCounters);
+      farPhysicsTick += 1;
+   }
+
+   int lastStrip = (map.sizeX - 1) / physicsStripWidth;
+   int cellsLeft = std::max(1, farPhysicsCells);
+
+   // strips of one phase never share cells, so a band runs across all of them at once
+   while (farPhysicsActive && cellsLeft > 0) {
+      std::vector<int> strips;
+      for (int strip = farPhysicsPhase; strip <= lastStrip; strip += physicsPhases) {
+         strips.push_back(strip);
+      }
+      int rowCells = std::max<int>(1, strips.size() * physicsStripWidth);
+      int rows = std::min(farPhysicsRow + 1, std::max(1, cellsLeft / rowCells));
+
+      Rectangle bounds = {0, float(farPhysicsRow - rows + 1), float(map.sizeX - 1), float(farPhysicsRow)};
+      farCellsPending += updatePhysicsStrips(strips, bounds, &physicsBounds, farLiquidCounters, mixBits(~map.seed) ^ farPhysicsTick);
+      cellsLeft -= rows * rowCells;
+      farPhysicsRow -= rows;
+
+      if (farPhysicsRow < 0) {
+         farPhysicsPhase += 1;
+         farPhysicsRow = map.sizeY - 1;
+         farPhysicsActive = (farPhysicsPhase < physicsPhases);
+      }
+   }
+
+   if (!farPhysicsActive) {
+      farCellsUpdated = farCellsPending;
+   }
+}
+
+int Physics::updatePhysicsStrips(const std::vector<int> &strips, const Rectangle &bounds, const Rectangle *skip, const std::vector<int> &counters, unsigned long long tick) {
+   // The bounds are cut into strips aligned to the awake plane's words. a cell update writes at most one column into
+   // the neighbouring strips, so strips that are physicsPhases apart never share cells, plane words or chunks and can
+   // run at the same time. callers run the phases one after another in the same order with or without threads, which
+   // keeps the results identical either way
+   std::vector<int> stripCells (strips.size());
+   auto updateStrip = [&](int i) {
+      int minX = std::max<int>(bounds.x, strips[i] * physicsStripWidth);
+      int maxX = std::min<int>(bounds.width, strips[i] * physicsStripWidth + physicsStripWidth - 1);
+      stripCells[i] = updatePhysicsStrip(minX, maxX, bounds.y, bounds.height, skip, counters, tick);
+   };
+
+   if (parallelPhysics) {
+      getThreadPool().run(strips.size(), updateStrip);
+   } else {
+      for (int i = 0; i < (int)strips.size(); ++i) {
+         updateStrip(i);
+      }
+   }
+
+   int cells = 0;
+   for (int stripCell: stripCells) {
+      cells += stripCell;
+   }
+   return cells;
+}
+
+int Physics::updatePhysicsStrip(int minX, int maxX, int minY, int maxY, const Rectangle *skip, const std::vector<int> &counters, unsigned long long tick) {
+   // Loop backwards to avoid updating most of the moving blocks twice. only awake cells are visited, each one is put
+   // to sleep first and woken up again by the map setters if anything in its neighbourhood changes
+   int cells = 0;
+   auto updateSpan = [&](int y, int spanMinX, int spanMaxX) {
+      for (int x = map.findLastInSpan(Plane::awake, y, spanMinX, spanMaxX); x >= spanMinX; x = map.findLastInSpan(Plane::awake, y, spanMinX, x - 1)) {
+         map.sleep(x, y);
+         updatePhysicsCell(x, y, counters, tick);
+         cells += 1;
+      }
+   };
+
+   for (int y = maxY; y >= minY; --y) {
+      // rows touching chunks a progressive load hasn't filled in yet stay awake and wait for them, cells move at most
+      // one tile so the rows right next to them are enough
+      if (!map.isAreaLoaded(minX - 1, y - 1, maxX - minX + 3, 3)) {
+         continue;
+      }
+
+      if (!skip || y < skip->y || y > skip->height || maxX < skip->x || minX > skip->width) {
+         updateSpan(y, minX, maxX);
+      } else {
+         updateSpan(y, std::max<int>(minX, skip->width + 1), maxX);
+         updateSpan(y, minX, std::min<int>(maxX, skip->x - 1));
+      }
+   }
+   return cells;
+}
+
+void Physics::updatePhysicsCell(int x, int y, const std::vector<int> &counters, unsigned long long tick) {
+   if (map.isAnyLiquid(x, y)) {
+      liquidid_t id = map.getLiquidId(x, y);
+
+      if (counters[id] >= getLiquidData(id).updateSpeed) {
+         updateLiquid(x, y, id);
+      } else {
+         map.keepAwake(x, y); // not this liquid's turn yet
+      }
+   }
+
+   BlockType type = map.getBlock(x, y).type;
+   if (BlockTypeHas(type, BlockType::sand)) {
+      updateSandPhysics(x, y, tick);
+   } else if (BlockTypeHas(type, BlockType::grass)) {
+      updateGrassPhysics(x, y, tick);
+   } else if (BlockTypeHas(type, BlockType::dirt)) {
+      updateDirtPhysics(x, y, tick);
+   } else if (BlockTypeHas(type, BlockType::torch)) {
+      updateTorchPhysics(x, y);
+   }
+}
+
+static constexpr unsigned char calculateFlowDown(unsigned char flow1, unsigned char flow2) {
+   unsigned char availableSpace = maxLiquidLayers - flow2;
+   return std::min(availableSpace, flow1);
+}
+
+static void applyFlowDown(unsigned char &flow1, unsigned char &flow2) {
+   unsigned char flowDown = calculateFlowDown(flow1, flow2);
+   flow1 -= flowDown;
+   flow2 += flowDown;
+}
+
+static void applyHalfFlowDown(unsigned char &flow1, unsigned char &flow2) {
+   unsigned char flowDown = calculateFlowDown(flow1, flow2);
+   unsigned char halfFlowDown = (flowDown == 1 ? 1 : flowDown / 2);
+   flow1 -= halfFlowDown;
+   flow2 += halfFlowDown;
+}
+
+bool Physics::handleLiquidToBlock(int x, int y, liquidid_t id) {
+   // nothing to react with when none of the neighbours hold liquid
+   if ((map.getPlaneBits(Plane::liquid, x - 1, y, 3) & 0b101) == 0 && !map.testPlane(Plane::liquid, x, y - 1) && !map.testPlane(Plane::liquid, x, y + 1)) {
+      return true;
+   }
+   LiquidData &data = getLiquidData(id);
+   for (const Vector2 &offset: {Vector2{1, 0}, Vector2{0, 1}, Vector2{-1, 0}, Vector2{0, -1}}) {
+      int dx = x + offset.x, dy = y + offset.y;
+      if (!map.isAnyLiquid(dx, dy) || map.isLiquidOfType(dx, dy, id)) {
+         continue;
+      }
+
+      if (map.getLiquidHeight(dx, dy) >= liquidToBlockThreshold && map.getLiquidHeight(x, y) >= liquidToBlockThreshold && map.isNotSolid(dx, dy)) {
+         liquidid_t target = map.getLiquidId(dx, dy);
+         auto conversion = data.conversionTable.find(target);
+         if (conversion != data.conversionTable.end()) {
+            map.setBlock(dx, dy, conversion->second);
+         }
+      }
+      map.setLiquid(x, y, 0, 0);
+   }
+   return map.isAnyLiquid(x, y);
+}
+
+void Physics::updateLiquid(int x, int y, liquidid_t id) {
+   if (!handleLiquidToBlock(x, y, id)) {
+      return;
+   }
+   liquidlayer_t height = map.getLiquidHeight(x, y);
+
+   // Delete the liquid if its height is zero
+   if (height == 0) {
+      map.setLiquid(x, y, 0, 0);
+      return;
+   }
+
+   // neighbour occupancy in one go, bit 0 is left and bit 2 is right
+   uint64_t liquidRow = map.getPlaneBits(Plane::liquid, x - 1, y, 3);
+   bool liquidLeft = liquidRow & 0b001;
+   bool liquidRight = liquidRow & 0b100;
+   bool liquidBelow = map.testPlane(Plane::liquid, x, y + 1);
+
+   // Handle liquid going down
+   if ((map.getBlock(x, y + 1).tile == TileType::ghost || map.is(x, y + 1, BlockType::flowable)) && !liquidBelow) {
+      map.swapLiquids(x, y, x, y + 1);
+      return;
+   } else if (liquidBelow && map.isLiquidOfType(x, y + 1, id) && map.getLiquidHeight(x, y + 1) < maxLiquidLayers) {
+      liquidlayer_t current = map.getLiquidHeight(x, y), below = map.getLiquidHeight(x, y + 1);
+      applyFlowDown(current, below);
+      map.setLiquid(x, y, id, current);
+      map.setLiquid(x, y + 1, id, below);
+   }
+
+   // Handle liquid going left
+   if (((map.getBlock(x - 1, y).tile == TileType::ghost || map.is(x - 1, y, BlockType::flowable)) && !liquidLeft)
+    || (liquidLeft && map.isLiquidOfType(x - 1, y, id) && map.getLiquidHeight(x - 1, y) < height && map.getLiquidHeight(x - 1, y) < maxLiquidLayers)) {
+      liquidlayer_t current = map.getLiquidHeight(x, y), left = map.getLiquidHeight(x - 1, y);
+      applyHalfFlowDown(current, left);
+      map.setLiquid(x, y, id, current);
+      map.setLiquid(x - 1, y, id, left);
+   }
+
+   // Handle liquid going right
+   if (((map.getBlock(x + 1, y).tile == TileType::ghost || map.is(x + 1, y, BlockType::flowable)) && !liquidRight)
+    || (liquidRight && map.isLiquidOfType(x + 1, y, id) && map.getLiquidHeight(x + 1, y) < height && map.getLiquidHeight(x + 1, y) < maxLiquidLayers)) {
+      liquidlayer_t current = map.getLiquidHeight(x, y), right = map.getLiquidHeight(x + 1, y);
+      applyHalfFlowDown(current, right);
+      map.setLiquid(x, y, id, current);
+      map.setLiquid(x + 1, y, id, right);
+   }
+}
+
+void Physics::updateSandPhysics(int x, int y, unsigned long long tick) {
+   if (map.isNotSolid(x, y + 1)) {
+      map.swapBlocks(x, y, x, y + 1);
+      return;
+   }
+
+   bool leftEmpty  = map.isNotSolid(x - 1, y + 1);
+   bool rightEmpty = map.isNotSolid(x + 1, y + 1);
+
+   // Hacky solution, but works
+   if (rightEmpty && leftEmpty && cellChance(x, y, tick, 50)) {
+      rightEmpty = false;
+   }
+
+   if (rightEmpty) {
+      map.swapBlocks(x, y, x + 1, y + 1);
+   } else if (leftEmpty) {
+      map.swapBlocks(x, y, x - 1, y + 1);
+   }
+}
+
+void Physics::updateGrassPhysics(int x, int y, unsigned long long tick) {
+   if (!map.is(x, y - 1, BlockType::solid)) {
+      return;
+   }
+
+   BlockState &state = map.blockStates[y * map.sizeX + x];
+   if (state.value2 == 0) {
+      state.value2 = cellRandomInt(x, y, tick, grassGrowSpeedMin, grassGrowSpeedMax);
+   }
+
+   state.value += 1;
+   map.keepAwake(x, y); // still growing
+   if (state.value >= state.value2) {
+      state.value = 0;
+      state.value2 = 0;
+
+      // grass says which dirt it turns into in blocks.txt, so neither depends on where they are in the file
+      blockid_t dirt = getBlockData(map.getBlock(x, y).id).turnsInto;
+      if (dirt != 0) {
+         map.setBlock(x, y, dirt);
+      }
+   }
+}
+
+void Physics::updateDirtPhysics(int x, int y, unsigned long long tick) {
+   if (map.is(x, y - 1, BlockType::solid)) {
+      return;
+   }
+
+   BlockState &state = map.blockStates[y * map.sizeX + x];
+   if (state.value2 == 0) {
+      state.value2 = cellRandomInt(x, y, tick, grassGrowSpeedMin, grassGrowSpeedMax);
+   }
+
+   state.value += 1;
+   map.keepAwake(x, y); // still growing
+   if (state.value >= state.value2) {
+      state.value = 0;
+      state.value2 = 0;
+
+      blockid_t grass = getBlockData(map.getBlock(x, y).id).turnsInto;
+      if (grass != 0) {
+         map.setBlock(x, y, grass);
+      }
+   }
+}
+
+void Physics::updateTorchPhysics(int x, int y) {
+   BlockState &state = map.blockStates[y * map.sizeX + x];
+   state.value = (state.value + 1) % 5;
+   map.keepAwake(x, y); // flame animation
+
+   if (map.getLiquidHeight(x, y) > liquidToBlockThreshold) {
+      map.deleteBlockWithoutDeletingLiquids(x, y);
+      return;
+   }
+   bool downEmpty = map.isNotSolid(x, y + 1);
+
+   if (downEmpty && map.isStable(x - 1, y)) {
+      state.value2 = 2;
+   } else if (downEmpty && map.isStable(x + 1, y)) {
+      state.value2 = 3;
+   } else if (downEmpty && !map.isWall(x, y, BlockType::empty)) {
+      state.value2 = 4;
+   } else if (!downEmpty && map.isStable(x, y - 1)) {
+      state.value2 = 1;
+   } else if (!downEmpty) {
+      state.value2 = 0;
+   } else {
+      map.deleteBlock(x, y);
+   }
+}
+
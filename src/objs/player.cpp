@@ -1,7 +1,6 @@
 #include "game/state.hpp"
+#include "mngr/assetHandles.hpp"
 #include "objs/player.hpp"
-#include "SRU/audio.hpp"
-#include "SRU/assets.hpp"
 #include "SRU/random.hpp"
 #include <raymath.h>
 
@@ -142,7 +141,7 @@ void Player::updateMovement() {
 
    jumpTimer -= fixedUpdateDT;
    if ((((!blockInput && IsKeyDown(KEY_SPACE)) && coyoteTimer > 0) || (onGround && foxTimer > 0)) && jumpTimer <= 0) {
-      playSound("jump");
+      playSound(getAssetHandles().jump);
       coyoteTimer = 0.f;
       jumpTimer = jumpTime;
 
@@ -169,6 +168,12 @@ void Player::updateMovement() {
 
 // Update collisions
 
+// rows without anything to collide with or swim in can be skipped as a whole. player is never wider than a word
+static bool isRowOccupied(const Map &map, int y, int minX, int maxX) {
+   int count = maxX - minX;
+   return (map.getPlaneBits(Plane::solid, minX, y, count) | map.getPlaneBits(Plane::platform, minX, y, count) | map.getPlaneBits(Plane::liquid, minX, y, count)) != 0;
+}
+
 void Player::updateCollisions(Map &map) {
    if (ignoreCollision) {
       ignoreCollision = false;
@@ -197,24 +202,29 @@ void Player::updateCollisions(Map &map) {
       onGround = collisionY = true;
    }
 
+   int minX = std::max(0, (int)position.x);
    int maxX = std::min(map.sizeX, int(position.x + playerSize.x) + 1);
    int maxY = std::min(map.sizeY, int(position.y + playerSize.y) + 1);
 
    for (int y = std::max(0, (int)position.y); y < maxY; ++y) {
-      for (int x = std::max(0, (int)position.x); x < maxX; ++x) {
+      if (!isRowOccupied(map, y, minX, maxX)) {
+         continue;
+      }
+
+      for (int x = minX; x < maxX; ++x) {
          if (map.isAnyLiquid(x, y) && map.getLiquidHeight(x, y) > playerLiquidThreshold) {
             liquidCounts[map.getLiquidId(x, y)] += 1;
             liquidsAboveHead += (y <= position.y + 1.0f);
          }
          honeyTileCount += map.is(x, y, BlockType::sticky);
 
-         if (((map.getBlock(x, y).platformOverride || map.is(x, y, BlockType::platform)) && (!blockInput && IsKeyDown(KEY_S))) || (!map.getBlock(x, y).platformOverride && !map.is(x, y, BlockType::solid))) {
+         if (((map.getBlockState(x, y).platformOverride || map.is(x, y, BlockType::platform)) && (!blockInput && IsKeyDown(KEY_S))) || (!map.getBlockState(x, y).platformOverride && !map.is(x, y, BlockType::solid))) {
             continue;
          }
 
          // Not necessary in both loops
-         blocksInHeadX1 += (y <= position.y + 1.0f && x >= position.x + playerSize.x / 2.0f && !map.is(x, y, BlockType::platform) && !map.blocks[y * map.sizeX + x].platformOverride);
-         blocksInHeadX2 += (y <= position.y + 1.0f && x <  position.x + playerSize.x / 2.0f && !map.is(x, y, BlockType::platform) && !map.blocks[y * map.sizeX + x].platformOverride);
+         blocksInHeadX1 += (y <= position.y + 1.0f && x >= position.x + playerSize.x / 2.0f && !map.is(x, y, BlockType::platform) && !map.blockStates[y * map.sizeX + x].platformOverride);
+         blocksInHeadX2 += (y <= position.y + 1.0f && x <  position.x + playerSize.x / 2.0f && !map.is(x, y, BlockType::platform) && !map.blockStates[y * map.sizeX + x].platformOverride);
 
          if (!CheckCollisionRecs({position.x, position.y, playerSize.x, playerSize.y}, {(float)x, (float)y, 1.f, 1.f})) {
             continue;
@@ -250,11 +260,16 @@ void Player::updateCollisions(Map &map) {
    feetCollisionY = 0;
 
    position.x = Clamp(position.x, 0.f, map.sizeX - playerSize.x);
+   minX = std::max(0, (int)position.x);
    maxX = std::min(map.sizeX, int(position.x + playerSize.x) + 1);
    maxY = std::min(map.sizeY, int(position.y + playerSize.y) + 1);
 
    for (int y = std::max(0, (int)position.y - 1); y < maxY; ++y) {
-      for (int x = std::max(0, (int)position.x); x < maxX; ++x) {
+      if (!isRowOccupied(map, y, minX, maxX)) {
+         continue;
+      }
+
+      for (int x = minX; x < maxX; ++x) {
          // Necessary to count in both loops for making the player stick to sticky walls
          if (map.isAnyLiquid(x, y) && map.getLiquidHeight(x, y) > playerLiquidThreshold) {
             liquidCounts[map.getLiquidId(x, y)] += 1;
@@ -393,7 +408,7 @@ void Player::updateAnimation() {
       }
 
       if (frameX != lastFrameX && (frameX == 4 || frameX == 11)) {
-         playSound("footstep", 0.7f);
+         playSound(getAssetHandles().footstep, 0.7f);
       }
 
       walkTimer -= .04f;
@@ -406,7 +421,7 @@ void Player::takeDamage(int damage, int critChance, float critDamage) {
    if (immunityFrame > 0.0f) {
       return;
    }
-   playSound("hurt");
+   playSound(getAssetHandles().hurt);
    bool critical = chance(critChance);
    int damageApplied = damage * (critical ? critDamage : 1.0f);
 
@@ -444,7 +459,7 @@ void Player::placeBlock() {
 // render functions
 
 void Player::render(float accumulator) const {
-   Texture2D &texture = getTexture("player");
+   Texture2D &texture = *getAssetHandles().player;
    const Vector2 drawPos = Vector2Lerp(previousPosition, position, accumulator / fixedUpdateDT);
 
    DrawTexturePro(texture, {frameX * playerFrameSizeX, 0.f, (flipX ? -playerFrameSizeX : playerFrameSizeX), playerFrameSizeY}, {drawPos.x, drawPos.y, playerSize.x, playerSize.y}, {0, 0}, 0, (timeSinceLastDamage <= 0.3f ? RED : WHITE));
@@ -1,5 +1,5 @@
 #include "ui/bar.hpp"
-#include "SRU/assets.hpp"
+#include "mngr/assetHandles.hpp"
 #include "SRU/render.hpp"
 #include <raymath.h>
 
@@ -18,7 +18,7 @@ void Bar::render() {
    if (texture.id == 0) return;
    drawTexture(texture, rect, origin, backgroundTint);
 
-   Shader &clipShader = getShader("clip");
+   Shader &clipShader = *getAssetHandles().clip;
    int progressLocation = GetShaderLocation(clipShader, "progress");
    SetShaderValue(clipShader, progressLocation, &progressInterpolation, SHADER_UNIFORM_FLOAT);
 
@@ -1,7 +1,7 @@
+#include "mngr/assetHandles.hpp"
 #include "mngr/input.hpp"
 #include "ui/button.hpp"
 #include "ui/keybindIndicator.hpp"
-#include "SRU/audio.hpp"
 #include "SRU/render.hpp"
 #include "SRU/util.hpp"
 #include <raymath.h>
@@ -44,11 +44,11 @@ void Button::update(float dt) {
    }
 
    if (!wasHovering && hovering) {
-      playSound("hover");
+      playSound(getAssetHandles().hover);
    }
 
    if (clicked) {
-      playSound("click");
+      playSound(getAssetHandles().click);
    }
 }
 
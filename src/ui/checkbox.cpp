@@ -1,7 +1,7 @@
+#include "mngr/assetHandles.hpp"
 #include "mngr/input.hpp"
 #include "ui/checkbox.hpp"
 #include "ui/keybindIndicator.hpp"
-#include "SRU/audio.hpp"
 #include "SRU/render.hpp"
 #include "SRU/util.hpp"
 
@@ -17,7 +17,7 @@ void CheckBox::update() {
 
       if (isMousePressedUI(MOUSE_BUTTON_LEFT)) {
          checked = !checked;
-         playSound("click");
+         playSound(getAssetHandles().click);
       }
    }
 }
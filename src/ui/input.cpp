@@ -1,6 +1,6 @@
+#include "mngr/assetHandles.hpp"
 #include "mngr/input.hpp"
 #include "ui/input.hpp"
-#include "SRU/audio.hpp"
 #include "SRU/render.hpp"
 #include "SRU/text.hpp"
 #include "SRU/util.hpp"
@@ -92,12 +92,12 @@ void Input::update(float dt) {
       }
 
       if (text.size() != previousTextSize) {
-         playSound("typing");
+         playSound(getAssetHandles().typing);
       }
    }
 
    if (wasTyping != typing) {
-      playSound("click");
+      playSound(getAssetHandles().click);
    }
 
    if (!wasTyping && typing) {
@@ -1,4 +1,5 @@
 #include "ui/keybindIndicator.hpp"
+#include "mngr/assetHandles.hpp"
 #include "SRU/render.hpp"
 #include "SRU/util.hpp"
 
@@ -11,6 +12,6 @@ void drawKeybindIndicator(Font font, const std::string &keybind, Vector2 center,
    Vector2 size = mapRatioToArea(keybindSize, WINDOW_AREA, CUBIC_RATIO);
    Vector2 position = center - mapRatioToArea(offset);
    
-   drawTexture("keybind", position, size, CENTER, tint);
+   drawTexture(*getAssetHandles().keybind, position, size, CENTER, tint);
    drawText(font, position, keybind.c_str(), getFontSizeScaled(fontSize), CENTER, BLACK);
 }
@@ -1,8 +1,7 @@
+#include "mngr/assetHandles.hpp"
 #include "mngr/input.hpp"
 #include "ui/button.hpp"
 #include "ui/popup.hpp"
-#include "SRU/audio.hpp"
-#include "SRU/assets.hpp"
 #include "SRU/render.hpp"
 #include "SRU/text.hpp"
 #include "SRU/util.hpp"
@@ -68,8 +67,8 @@ void fadeIn(float dt) {
 // Init functions
 
 void initPopups() {
-   Texture texture = getTexture("button");
-   Font font = getFont("andy");
+   Texture texture = *getAssetHandles().button;
+   Font font = *getAssetHandles().font;
 
    confirmationButton.init(font, texture, CENTER, "YES");
    denialButton.init(font, texture, CENTER, "NO");
@@ -80,13 +79,13 @@ void initPopups() {
 // Popup functions
 
 void insertPopup(const std::string &header, const std::string &body, PopupType type) {
-   std::string wrappedBody = wrap(body, getFont("andy"), rect.width - mapRatioToWidth(0.05f, rect, CUBIC_RATIO), getFontSizeScaled(bodyFontSize));
+   std::string wrappedBody = wrap(body, *getAssetHandles().font, rect.width - mapRatioToWidth(0.05f, rect, CUBIC_RATIO), getFontSizeScaled(bodyFontSize));
    popups.emplace_back(header, wrappedBody, type);
 
    if (type == PopupType::error) {
-      playSound("failure");
+      playSound(getAssetHandles().failure);
    } else {
-      playSound("notice");
+      playSound(getAssetHandles().notice);
    }
 }
 
@@ -151,10 +150,10 @@ void renderPopups() {
    if (popups.empty()) {
       return;
    }
-   Font font = getFont("andy");
+   Font font = *getAssetHandles().font;
    Popup &popup = popups.back();
 
-   drawTexture("popup_frame", rect, TOP_LEFT);
+   drawTexture(*getAssetHandles().popupFrame, rect, TOP_LEFT);
    drawTextResponsive(font, headerPosition, popup.header.c_str(), headerFontSize, CENTER, WHITE, rect);
    drawTextResponsive(font, bodyPosition, popup.body.c_str(), bodyFontSize, TOP_CENTER, WHITE, rect);
 